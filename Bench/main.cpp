@@ -0,0 +1,553 @@
+/*
+ * Bench: scaling benchmarks for Day1 to Day4.
+ *
+ * Generates seeded synthetic inputs in each day's format, from a few KB up
+ * to tens of GB, runs the day's solution on them several times and prints
+ * one JSON object per input on stdout:
+ *
+ *  {"day":1,"digits":5,"seed":1,"bytes":...,"rows":...,"runs":5,
+ *   "phases":{"generate":{"p50_ms":...,"p99_ms":...},"parse":{...},...,"solve":{...}},
+ *   "mb_per_s":...,"rows_per_s":...,"peak_rss_kb":...,"output":"..."}
+ *
+ * The solutions run with --stats=json, and each of their phases (parse,
+ * sort, scan, ...) gets its own percentiles; "solve" is the whole process.
+ * Throughput is taken from the median solve time. Day1 runs once per ID
+ * width, since the width picks its sort. Generated inputs are kept in the
+ * work directory, named after day, size and seed, and reused by later runs
+ * with the same parameters.
+ */
+
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <cstdint>
+#include <cmath>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <charconv>
+#include <filesystem>
+
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+/*
+ * SplitMix64: a small generator whose sequence depends on nothing but the
+ * seed, so inputs are identical across compilers and standard libraries
+ * (unlike the <random> distributions).
+ */
+class Rng {
+public:
+    explicit Rng(uint64_t seed) : state_ {seed} {}
+
+    uint64_t next() {
+        auto z {state_ += 0x9e3779b97f4a7c15};
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+        return z ^ (z >> 31);
+    }
+
+    // Uniform in [0, n).
+    uint64_t below(uint64_t n) {
+        return next() % n;
+    }
+
+    // Uniform in [low, high].
+    int between(int low, int high) {
+        return low + static_cast<int>(below(static_cast<uint64_t>(high - low + 1)));
+    }
+
+    bool chance(double p) {
+        return static_cast<double>(next() >> 11) * 0x1.0p-53 < p;
+    }
+
+private:
+    uint64_t state_;
+};
+
+struct Generated {
+    uint64_t bytes {0};
+    uint64_t rows {0};
+};
+
+/*
+ * Writes lines produced by line(rng, out) to "path" until "target_bytes" or
+ * "max_rows" is reached, whichever comes first. Lines are gathered in a
+ * buffer so that even tens of GB go out in large writes.
+ */
+template <typename Line>
+bool write_lines(const std::string& path, uint64_t target_bytes, uint64_t max_rows,
+                 Rng& rng, Line&& line, Generated& generated) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+    constexpr size_t flush_bytes {1 << 20};
+    std::string buffer;
+    buffer.reserve(flush_bytes + 65536);
+    while (generated.bytes < target_bytes && generated.rows < max_rows) {
+        const auto before {buffer.size()};
+        line(rng, buffer);
+        generated.bytes += buffer.size() - before;
+        ++generated.rows;
+        if (buffer.size() >= flush_bytes) {
+            file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+    }
+    file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    return static_cast<bool>(file);
+}
+
+/*
+ * Day1: two columns of "digits"-digit location IDs, separated by three
+ * spaces. The puzzle uses 5 digits; the width sets the value range, which
+ * picks the sort (counting, or radix with 8, 11 or 16-bit digits).
+ */
+void day1_line(Rng& rng, std::string& out, int digits) {
+    int low {1};
+    for (int d = 1; d < digits; ++d) {
+        low *= 10;
+    }
+    const auto high {low * 10 - 1};
+    out += std::to_string(rng.between(low, high));
+    out += "   ";
+    out += std::to_string(rng.between(low, high));
+    out += '\n';
+}
+
+/*
+ * Day2: reports of 5 to 8 levels walking up or down by 1 to 3, with a
+ * chance per level of a step that breaks the rules (too big, flat or turning
+ * back), so that all verdicts show up.
+ */
+void day2_line(Rng& rng, std::string& out) {
+    const auto levels {rng.between(5, 8)};
+    const auto direction {rng.chance(0.5) ? 1 : -1};
+    auto level {direction > 0 ? rng.between(1, 40) : rng.between(60, 99)};
+    for (int i = 0; i < levels; ++i) {
+        if (i > 0) {
+            out += ' ';
+            level += rng.chance(0.08) ? rng.between(-4, 4) : direction * rng.between(1, 3);
+        }
+        out += std::to_string(level);
+    }
+    out += '\n';
+}
+
+/*
+ * Day3: corrupted memory. Each token is, with probability "density", an
+ * instruction (mostly mul(X,Y), sometimes do() or don't()), and otherwise
+ * noise: a stray character, or now and then a near miss such as "mul(4*"
+ * or "mul[3,7]". Lines are about 4 KB long, like the puzzle input.
+ */
+void day3_line(Rng& rng, std::string& out, double density) {
+    constexpr std::string_view noise {"()[]{}<>,'!@#$%^&*+-?:; _mulwhatfromselectdon0123456789"};
+    constexpr std::string_view near_misses[] {
+        "mul(4*", "mul[3,7]", "mul ( 2 , 4 )", "mul(6,9!", "don't", "do(", "mul(1234,5)"};
+    constexpr size_t line_bytes {4096};
+    const auto start {out.size()};
+    while (out.size() - start < line_bytes) {
+        if (rng.chance(density)) {
+            const auto pick {rng.below(10)};
+            if (pick == 0) {
+                out += "do()";
+            } else if (pick == 1) {
+                out += "don't()";
+            } else {
+                out += "mul(";
+                out += std::to_string(rng.between(0, 999));
+                out += ',';
+                out += std::to_string(rng.between(0, 999));
+                out += ')';
+            }
+        } else if (rng.chance(0.01)) {
+            out += near_misses[rng.below(std::size(near_misses))];
+        } else {
+            out += noise[rng.below(noise.size())];
+        }
+    }
+    out += '\n';
+}
+
+// Day4: a "cols"-wide row of the letters X, M, A and S.
+void day4_line(Rng& rng, std::string& out, uint64_t cols) {
+    constexpr std::string_view letters {"XMAS"};
+    for (uint64_t c = 0; c < cols; ++c) {
+        out += letters[rng.below(letters.size())];
+    }
+    out += '\n';
+}
+
+/*
+ * Generates the input for "day" into "path", about "target_bytes" long.
+ * "digits" is the Day1 ID width. Day4 grids are square.
+ */
+bool generate(int day, const std::string& path, uint64_t target_bytes, uint64_t seed,
+              int digits, double density, Generated& generated) {
+    Rng rng {seed};
+    constexpr auto unlimited {~uint64_t{0}};
+    switch (day) {
+        case 1:
+            return write_lines(path, target_bytes, unlimited, rng, [digits](Rng& r, std::string& out) {
+                day1_line(r, out, digits);
+            }, generated);
+        case 2:
+            return write_lines(path, target_bytes, unlimited, rng, day2_line, generated);
+        case 3:
+            return write_lines(path, target_bytes, unlimited, rng, [density](Rng& r, std::string& out) {
+                day3_line(r, out, density);
+            }, generated);
+        case 4: {
+            const auto root {static_cast<uint64_t>(std::sqrt(static_cast<double>(target_bytes)))};
+            const auto side {std::max<uint64_t>(4, root)};
+            return write_lines(path, unlimited, side, rng, [side](Rng& r, std::string& out) {
+                day4_line(r, out, side);
+            }, generated);
+        }
+        default:
+            return false;
+    }
+}
+
+struct RunResult {
+    double seconds {0};
+    long peak_rss_kb {0};
+    int status {0};
+};
+
+/*
+ * Runs "argv" with stdout sent to "output_path" and stderr to "error_path",
+ * timing it and reading its peak resident set size from wait4.
+ */
+bool run_process(const std::vector<std::string>& args, const std::string& output_path,
+                 const std::string& error_path, RunResult& result) {
+    std::vector<char*> argv;
+    for (const auto& arg : args) {
+        argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, output_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, error_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    const auto start {std::chrono::steady_clock::now()};
+    pid_t pid {};
+    const auto spawned {posix_spawn(&pid, argv[0], &actions, nullptr, argv.data(), environ)};
+    posix_spawn_file_actions_destroy(&actions);
+    if (spawned != 0) {
+        return false;
+    }
+
+    int status {0};
+    struct rusage usage {};
+    if (wait4(pid, &status, 0, &usage) != pid) {
+        return false;
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.peak_rss_kb = usage.ru_maxrss;
+    result.status = status;
+    return true;
+}
+
+// Nearest-rank percentile of "samples", in milliseconds.
+double percentile_ms(std::vector<double> samples, double p) {
+    if (samples.empty()) {
+        return 0;
+    }
+    std::sort(samples.begin(), samples.end());
+    const auto rank {static_cast<size_t>(std::ceil(p * static_cast<double>(samples.size())))};
+    return samples[std::max<size_t>(rank, 1) - 1] * 1e3;
+}
+
+std::string json_escape(std::string_view text) {
+    std::string escaped;
+    for (const auto ch : text) {
+        switch (ch) {
+            case '"':  escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\t': escaped += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(ch) < 0x20) {
+                    escaped += ' ';
+                } else {
+                    escaped += ch;
+                }
+        }
+    }
+    return escaped;
+}
+
+// Timing samples of one phase, in seconds, under its name.
+struct PhaseSamples {
+    std::string name;
+    std::vector<double> seconds;
+};
+
+void add_sample(std::vector<PhaseSamples>& phases, std::string_view name, double seconds) {
+    auto it {std::find_if(phases.begin(), phases.end(), [&](const PhaseSamples& phase) {
+        return phase.name == name;
+    })};
+    if (it == phases.end()) {
+        phases.push_back({std::string {name}, {}});
+        it = phases.end() - 1;
+    }
+    it->seconds.push_back(seconds);
+}
+
+/*
+ * Adds the phase times of a solution's --stats=json report (a line of the
+ * form {"counters":...,"phases":[{"name":"parse","ms":1.5,...},...]}) found
+ * in "text". Returns false if there is no report.
+ */
+bool read_stats(std::string_view text, std::vector<PhaseSamples>& phases) {
+    const auto report {text.rfind("{\"counters\":")};
+    if (report == std::string_view::npos) {
+        return false;
+    }
+    constexpr std::string_view name_key {"{\"name\":\""};
+    constexpr std::string_view ms_key {"\"ms\":"};
+    auto at {report};
+    while ((at = text.find(name_key, at)) != std::string_view::npos) {
+        const auto name_begin {at + name_key.size()};
+        const auto name_end {text.find('"', name_begin)};
+        const auto ms {text.find(ms_key, name_end)};
+        if (name_end == std::string_view::npos || ms == std::string_view::npos) {
+            return false;
+        }
+        const std::string number {text.substr(ms + ms_key.size(), 32)};
+        add_sample(phases, text.substr(name_begin, name_end - name_begin), std::strtod(number.c_str(), nullptr) / 1e3);
+        at = ms;
+    }
+    return true;
+}
+
+std::string phase_json(const std::vector<double>& samples) {
+    std::ostringstream out;
+    out << "{\"p50_ms\":" << percentile_ms(samples, 0.50)
+        << ",\"p99_ms\":" << percentile_ms(samples, 0.99)
+        << ",\"samples\":" << samples.size() << "}";
+    return out.str();
+}
+
+/*
+ * Parses a size such as "64K", "10M" or "20G" (powers of 1024; a plain number
+ * is bytes). Returns false if it is malformed or zero.
+ */
+bool parse_size(std::string_view text, uint64_t& bytes) {
+    uint64_t value {0};
+    const auto [rest, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (ec != std::errc() || value == 0) {
+        return false;
+    }
+    const std::string_view suffix {rest, static_cast<size_t>(text.data() + text.size() - rest)};
+    uint64_t scale {1};
+    if (suffix == "K" || suffix == "KB") {
+        scale = uint64_t{1} << 10;
+    } else if (suffix == "M" || suffix == "MB") {
+        scale = uint64_t{1} << 20;
+    } else if (suffix == "G" || suffix == "GB") {
+        scale = uint64_t{1} << 30;
+    } else if (!suffix.empty()) {
+        return false;
+    }
+    bytes = value * scale;
+    return true;
+}
+
+struct Options {
+    std::vector<int> days {1, 2, 3, 4};
+    // Day1 ID widths, one run each.
+    std::vector<int> digits {3, 5, 7, 9};
+    uint64_t bytes {1 << 20};
+    uint64_t seed {1};
+    int runs {5};
+    double density {0.04};
+    std::string bin_dir {"."};
+    std::string work_dir {std::filesystem::temp_directory_path().string()};
+    bool regenerate {false};
+    // Passed on to every solution, after the input file.
+    std::vector<std::string> day_args;
+};
+
+bool parse_options(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg {argv[i]};
+        const auto has_value {i + 1 < argc};
+        if (arg == "--") {
+            options.day_args.assign(argv + i + 1, argv + argc);
+            break;
+        } else if (arg == "--day" && has_value) {
+            const std::string_view value {argv[++i]};
+            if (value == "all") {
+                options.days = {1, 2, 3, 4};
+            } else if (value.size() == 1 && value[0] >= '1' && value[0] <= '4') {
+                options.days = {value[0] - '0'};
+            } else {
+                return false;
+            }
+        } else if (arg == "--digits" && has_value) {
+            const std::string_view value {argv[++i]};
+            if (value == "all") {
+                options.digits = {3, 5, 7, 9};
+            } else if (value.size() == 1 && value[0] >= '1' && value[0] <= '9') {
+                options.digits = {value[0] - '0'};
+            } else {
+                return false;
+            }
+        } else if (arg == "--size" && has_value) {
+            if (!parse_size(argv[++i], options.bytes)) {
+                return false;
+            }
+        } else if ((arg == "--seed" || arg == "--runs") && has_value) {
+            const std::string_view value {argv[++i]};
+            uint64_t number {0};
+            const auto [_, ec] = std::from_chars(value.data(), value.data() + value.size(), number);
+            if (ec != std::errc()) {
+                return false;
+            }
+            if (arg == "--seed") {
+                options.seed = number;
+            } else if (number > 0) {
+                options.runs = static_cast<int>(number);
+            } else {
+                return false;
+            }
+        } else if (arg == "--density" && has_value) {
+            char* end {nullptr};
+            options.density = std::strtod(argv[++i], &end);
+            if (*end != '\0' || !(options.density >= 0 && options.density <= 1)) {
+                return false;
+            }
+        } else if (arg == "--bin-dir" && has_value) {
+            options.bin_dir = argv[++i];
+        } else if (arg == "--work-dir" && has_value) {
+            options.work_dir = argv[++i];
+        } else if (arg == "--regenerate") {
+            options.regenerate = true;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Benchmarks one input of "day" ("digits" wide for Day1) and prints its JSON
+ * line. Returns false, after reporting why, if it could not.
+ */
+bool bench(const Options& options, int day, int digits) {
+    const auto tag {"day" + std::to_string(day)};
+    auto input_path {options.work_dir + "/bench-" + tag + "-" + std::to_string(options.bytes) +
+                     "-" + std::to_string(options.seed)};
+    if (day == 1) {
+        input_path += "-d" + std::to_string(digits);
+    } else if (day == 3) {
+        input_path += "-" + std::to_string(options.density);
+    }
+    input_path += ".txt";
+
+    // The row count is only known after generating, so it is stored next to the input.
+    const auto rows_path {input_path + ".rows"};
+    Generated generated;
+    std::vector<PhaseSamples> phases;
+    std::ifstream rows_file(rows_path);
+    const auto cached {!options.regenerate && std::filesystem::exists(input_path) &&
+                       static_cast<bool>(rows_file >> generated.rows)};
+    if (cached) {
+        generated.bytes = std::filesystem::file_size(input_path);
+        phases.push_back({"generate", {}});
+    } else {
+        const auto start {std::chrono::steady_clock::now()};
+        if (!generate(day, input_path, options.bytes, options.seed, digits, options.density, generated)) {
+            std::cerr << "Error: could not write '" << input_path << "'.\n";
+            return false;
+        }
+        add_sample(phases, "generate", std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        std::ofstream(rows_path) << generated.rows << "\n";
+    }
+
+    std::vector<std::string> args {options.bin_dir + "/" + tag, input_path};
+    args.insert(args.end(), options.day_args.begin(), options.day_args.end());
+    // Unless the caller asked for another format, the phases come as JSON on stderr.
+    if (std::none_of(args.begin(), args.end(), [](const std::string& arg) { return arg.starts_with("--stats"); })) {
+        args.push_back("--stats=json");
+    }
+    const auto output_path {input_path + ".out"};
+    const auto error_path {input_path + ".err"};
+
+    std::vector<double> solve_seconds;
+    long peak_rss_kb {0};
+    for (int run = 0; run < options.runs; ++run) {
+        RunResult result;
+        if (!run_process(args, output_path, error_path, result)) {
+            std::cerr << "Error: could not run '" << args[0] << "'.\n";
+            return false;
+        }
+        std::ostringstream errors;
+        errors << std::ifstream(error_path).rdbuf();
+        if (!WIFEXITED(result.status) || WEXITSTATUS(result.status) != 0) {
+            std::cerr << "Error: '" << args[0] << "' failed on '" << input_path << "':\n" << errors.str();
+            return false;
+        }
+        read_stats(errors.str(), phases);
+        solve_seconds.push_back(result.seconds);
+        peak_rss_kb = std::max(peak_rss_kb, result.peak_rss_kb);
+    }
+
+    std::ostringstream output;
+    output << std::ifstream(output_path).rdbuf();
+
+    const auto median_seconds {percentile_ms(solve_seconds, 0.50) / 1e3};
+    std::cout << "{\"day\":" << day;
+    if (day == 1) {
+        std::cout << ",\"digits\":" << digits;
+    }
+    std::cout << ",\"seed\":" << options.seed
+              << ",\"bytes\":" << generated.bytes
+              << ",\"rows\":" << generated.rows
+              << ",\"runs\":" << options.runs
+              << ",\"phases\":{";
+    for (const auto& phase : phases) {
+        std::cout << "\"" << json_escape(phase.name) << "\":" << phase_json(phase.seconds) << ",";
+    }
+    std::cout << "\"solve\":" << phase_json(solve_seconds) << "}"
+              << ",\"mb_per_s\":" << static_cast<double>(generated.bytes) / 1e6 / median_seconds
+              << ",\"rows_per_s\":" << static_cast<double>(generated.rows) / median_seconds
+              << ",\"peak_rss_kb\":" << peak_rss_kb
+              << ",\"output\":\"" << json_escape(output.str()) << "\"}\n";
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        std::cerr << "Usage: " << argv[0] << " [--day 1|2|3|4|all] [--digits 1-9|all] [--size BYTES[K|M|G]] [--seed N]"
+                  << " [--runs N] [--density D] [--bin-dir DIR] [--work-dir DIR] [--regenerate] [-- DAY-OPTIONS...]\n"
+                  << "Runs DIR/day1 ... DIR/day4 on generated inputs and prints one JSON object per input.\n";
+        return 1;
+    }
+
+    for (const auto day : options.days) {
+        for (const auto digits : day == 1 ? options.digits : std::vector<int> {0}) {
+            if (!bench(options, day, digits)) {
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,96 @@
+/*
+ * Read-only view of a whole input file, shared by the days.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace aoc {
+
+/*
+ * Regular files are memory-mapped, so parsers read the page cache directly
+ * without a copy; pipes, FIFOs and stdin ("-"), which can't be mapped, are
+ * read in chunks into memory. The mapping is released when the object goes
+ * out of scope.
+ */
+class FileBuffer {
+public:
+    explicit FileBuffer(const std::string& filename) {
+        const auto from_stdin {filename == "-"};
+        const auto fd {from_stdin ? STDIN_FILENO : ::open(filename.c_str(), O_RDONLY)};
+        if (fd < 0) {
+            return;
+        }
+        struct stat st {};
+        if (::fstat(fd, &st) == 0) {
+            ok_ = S_ISREG(st.st_mode) ? map(fd, static_cast<size_t>(st.st_size)) : read_all(fd);
+        }
+        if (!from_stdin) {
+            ::close(fd);
+        }
+    }
+
+    ~FileBuffer() {
+        if (mapped_ != nullptr) {
+            ::munmap(mapped_, size_);
+        }
+    }
+
+    FileBuffer(const FileBuffer&) = delete;
+    FileBuffer& operator=(const FileBuffer&) = delete;
+
+    bool ok() const { return ok_; }
+
+    std::string_view view() const {
+        return mapped_ != nullptr ? std::string_view{static_cast<const char*>(mapped_), size_}
+                                  : std::string_view{buffer_};
+    }
+
+private:
+    bool map(int fd, size_t size) {
+        if (size == 0) {
+            return true;
+        }
+        void* addr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            // Some special files report a size but can't be mapped.
+            return read_all(fd);
+        }
+        // Inputs are consumed front to back exactly once.
+        ::madvise(addr, size, MADV_SEQUENTIAL);
+        mapped_ = addr;
+        size_ = size;
+        return true;
+    }
+
+    bool read_all(int fd) {
+        constexpr size_t chunk {size_t{1} << 20};
+        while (true) {
+            const auto used {buffer_.size()};
+            buffer_.resize(used + chunk);
+            const auto got {::read(fd, buffer_.data() + used, chunk)};
+            if (got < 0) {
+                return false;
+            }
+            buffer_.resize(used + static_cast<size_t>(got));
+            if (got == 0) {
+                return true;
+            }
+        }
+    }
+
+    void* mapped_ {nullptr};
+    size_t size_ {0};
+    std::string buffer_;
+    bool ok_ {false};
+};
+
+}  // namespace aoc
@@ -0,0 +1,108 @@
+/*
+ * Whitespace and integer scanning over in-memory text, shared by the days.
+ */
+
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace aoc {
+
+inline bool is_space(char ch) {
+    return ch == ' ' || ch == '\n' || ch == '\r' || ch == '\t' || ch == '\v' || ch == '\f';
+}
+
+/*
+ * Counts the lines of "text": its '\n' bytes, 16 at a time when SSE2 is
+ * available, plus an unterminated last line.
+ */
+inline size_t count_lines(std::string_view text) {
+    const char* p {text.data()};
+    const char* const end {p + text.size()};
+    size_t lines {0};
+#if defined(__SSE2__)
+    const auto newline {_mm_set1_epi8('\n')};
+    for (; p + 16 <= end; p += 16) {
+        const auto chunk {_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))};
+        const auto mask {_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline))};
+        lines += static_cast<size_t>(__builtin_popcount(mask));
+    }
+#endif
+    for (; p < end; ++p) {
+        lines += (*p == '\n');
+    }
+    if (!text.empty() && text.back() != '\n') {
+        ++lines;
+    }
+    return lines;
+}
+
+/*
+ * Returns the first non-whitespace byte at or after "p" (or "end").
+ * Runs of blanks are skipped 16 bytes at a time when SSE2 is available.
+ */
+inline const char* skip_spaces(const char* p, const char* end) {
+#if defined(__SSE2__)
+    // Whitespace is ' ' or one of '\t' '\n' '\v' '\f' '\r' (0x09..0x0d).
+    const auto blank {_mm_set1_epi8(' ')};
+    const auto ctrl_low {_mm_set1_epi8('\t' - 1)};
+    const auto ctrl_high {_mm_set1_epi8('\r' + 1)};
+    while (p + 16 <= end) {
+        const auto chunk {_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))};
+        const auto is_ctrl {_mm_and_si128(_mm_cmpgt_epi8(chunk, ctrl_low),
+                                          _mm_cmplt_epi8(chunk, ctrl_high))};
+        const auto is_blank {_mm_or_si128(_mm_cmpeq_epi8(chunk, blank), is_ctrl)};
+        const auto mask {static_cast<unsigned>(_mm_movemask_epi8(is_blank))};
+        if (mask != 0xFFFFu) {
+            return p + __builtin_ctz(~mask);
+        }
+        p += 16;
+    }
+#endif
+    while (p < end && is_space(*p)) {
+        ++p;
+    }
+    return p;
+}
+
+/*
+ * Parses the optionally negative decimal int at "p" and moves "p" past it.
+ * Accepts the same text as std::from_chars. Up to 9 digits can't overflow,
+ * so those are accumulated directly and only longer numbers go through
+ * from_chars for its range check.
+ * Returns false, leaving "p" alone, if no int starts there or it overflows.
+ */
+inline bool parse_int(const char*& p, const char* end, int& value) {
+    const char* q {p};
+    const auto negative {q < end && *q == '-'};
+    q += negative;
+    const char* const digits {q};
+    uint32_t magnitude {0};
+    while (q < end && q - digits < 9 && static_cast<unsigned char>(*q - '0') < 10) {
+        magnitude = magnitude * 10 + static_cast<uint32_t>(*q - '0');
+        ++q;
+    }
+    if (q == digits) {
+        return false;
+    }
+    if (q < end && static_cast<unsigned char>(*q - '0') < 10) {
+        const auto [after, ec] = std::from_chars(p, end, value);
+        if (ec != std::errc()) {
+            return false;
+        }
+        p = after;
+        return true;
+    }
+    value = negative ? -static_cast<int>(magnitude) : static_cast<int>(magnitude);
+    p = q;
+    return true;
+}
+
+}  // namespace aoc
@@ -0,0 +1,368 @@
+/*
+ * On-disk cache of results, keyed by the content of the input.
+ *
+ * An entry is named after the solver version tag, the XXH64 hash and the
+ * size of the input bytes, so changing either the input or the solver (by
+ * bumping its tag) misses. Entries are written to a temporary file and
+ * renamed into place, so readers never see a partial one. The directory is
+ * kept under a bound on the disk space of its entries (allocated blocks, not
+ * content bytes) by evicting the least recently used ones: hits refresh an
+ * entry's mtime, and eviction removes the oldest first. The directory is
+ * only scanned once a process stores, so a run of hits costs no scan.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "file_buffer.h"
+#include "stats.h"
+
+namespace aoc {
+
+/*
+ * XXH64 of "data" (the reference algorithm by Yann Collet), for little-endian
+ * machines: 32-byte stripes through four accumulators, then the tail.
+ */
+inline uint64_t xxh64(std::string_view data, uint64_t seed = 0) {
+    constexpr uint64_t prime1 {0x9E3779B185EBCA87ull};
+    constexpr uint64_t prime2 {0xC2B2AE3D27D4EB4Full};
+    constexpr uint64_t prime3 {0x165667B19E3779F9ull};
+    constexpr uint64_t prime4 {0x85EBCA77C2B2AE63ull};
+    constexpr uint64_t prime5 {0x27D4EB2F165667C5ull};
+
+    const auto read64 = [](const char* p) {
+        uint64_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    };
+    const auto read32 = [](const char* p) {
+        uint32_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    };
+    const auto round = [](uint64_t acc, uint64_t input) {
+        acc += input * prime2;
+        return std::rotl(acc, 31) * prime1;
+    };
+    const auto merge = [&](uint64_t acc, uint64_t value) {
+        acc ^= round(0, value);
+        return acc * prime1 + prime4;
+    };
+
+    const char* p {data.data()};
+    const char* const end {p + data.size()};
+    uint64_t hash;
+    if (data.size() >= 32) {
+        uint64_t v1 {seed + prime1 + prime2};
+        uint64_t v2 {seed + prime2};
+        uint64_t v3 {seed};
+        uint64_t v4 {seed - prime1};
+        for (; p + 32 <= end; p += 32) {
+            v1 = round(v1, read64(p));
+            v2 = round(v2, read64(p + 8));
+            v3 = round(v3, read64(p + 16));
+            v4 = round(v4, read64(p + 24));
+        }
+        hash = std::rotl(v1, 1) + std::rotl(v2, 7) + std::rotl(v3, 12) + std::rotl(v4, 18);
+        hash = merge(hash, v1);
+        hash = merge(hash, v2);
+        hash = merge(hash, v3);
+        hash = merge(hash, v4);
+    } else {
+        hash = seed + prime5;
+    }
+    hash += data.size();
+
+    for (; p + 8 <= end; p += 8) {
+        hash ^= round(0, read64(p));
+        hash = std::rotl(hash, 27) * prime1 + prime4;
+    }
+    if (p + 4 <= end) {
+        hash ^= read32(p) * prime1;
+        hash = std::rotl(hash, 23) * prime2 + prime3;
+        p += 4;
+    }
+    for (; p < end; ++p) {
+        hash ^= static_cast<unsigned char>(*p) * prime5;
+        hash = std::rotl(hash, 11) * prime1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= prime2;
+    hash ^= hash >> 29;
+    hash *= prime3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+/*
+ * The cache flags of a day: "--cache DIR" enables it, "--cache-size MiB"
+ * bounds its disk space (64 MiB by default).
+ */
+struct CacheOptions {
+    std::string dir;
+    uint64_t max_bytes {uint64_t{64} << 20};
+    // Set when a flag had an invalid value, which has been reported.
+    bool invalid {false};
+
+    bool enabled() const {
+        return !dir.empty();
+    }
+
+    /*
+     * Consumes the cache flag at argv[i] and its value, advancing "i".
+     * Returns false if argv[i] is not a cache flag.
+     */
+    bool parse_flag(int argc, char* argv[], int& i) {
+        const std::string_view arg {argv[i]};
+        if (i + 1 >= argc || (arg != "--cache" && arg != "--cache-size")) {
+            return false;
+        }
+        const std::string_view value {argv[++i]};
+        if (arg == "--cache") {
+            dir = value;
+            return true;
+        }
+        uint64_t mebibytes {0};
+        const auto [_, ec] = std::from_chars(value.data(), value.data() + value.size(), mebibytes);
+        if (ec != std::errc() || mebibytes == 0) {
+            std::cerr << "Invalid cache size '" << value << "'.\n";
+            invalid = true;
+        }
+        max_bytes = mebibytes << 20;
+        return true;
+    }
+};
+
+/*
+ * The cache directory. Lookups and stores may come from several threads;
+ * the hit and miss counts cover this process only.
+ */
+class ResultCache {
+public:
+    // Creates "options.dir" if needed; check ok() afterwards.
+    explicit ResultCache(const CacheOptions& options)
+        : dir_ {options.dir}, max_bytes_ {options.max_bytes} {
+        std::error_code ec;
+        std::filesystem::create_directories(dir_, ec);
+        ok_ = !ec && std::filesystem::is_directory(dir_, ec);
+    }
+
+    ResultCache(const ResultCache&) = delete;
+    ResultCache& operator=(const ResultCache&) = delete;
+
+    bool ok() const { return ok_; }
+    uint64_t hits() const { return hits_; }
+    uint64_t misses() const { return misses_; }
+
+    /*
+     * The entry name for "input" as solved by "solver". That is the solver's
+     * version tag ("day1-v1", ...): bump it whenever the solver's result
+     * lines change, so entries of the old version miss.
+     */
+    static std::string key(std::string_view solver, std::string_view input) {
+        std::ostringstream key;
+        key << solver << '-' << std::hex << std::setw(16) << std::setfill('0') << xxh64(input)
+            << '-' << std::dec << input.size();
+        return key.str();
+    }
+
+    // Reads the entry "key" into "output", counting a hit or a miss.
+    bool lookup(const std::string& key, std::string& output) {
+        const auto path {dir_ / (key + suffix)};
+        std::ifstream file {path, std::ios::binary};
+        std::string header;
+        if (!file || !std::getline(file, header) || header != key) {
+            ++misses_;
+            return false;
+        }
+        output.assign(std::istreambuf_iterator<char> {file}, std::istreambuf_iterator<char> {});
+        // Most recently used from now on.
+        ::utimensat(AT_FDCWD, path.c_str(), nullptr, 0);
+        ++hits_;
+        return true;
+    }
+
+    // Writes "output" as the entry "key", then evicts down to the size bound.
+    void store(const std::string& key, std::string_view output) {
+        static std::atomic<unsigned> sequence {0};
+        const auto temp {dir_ / (".tmp-" + std::to_string(::getpid()) + "-" + std::to_string(sequence++))};
+        {
+            std::ofstream file {temp, std::ios::binary | std::ios::trunc};
+            file << key << '\n' << output;
+            if (!file.flush()) {
+                std::filesystem::remove(temp);
+                return;
+            }
+        }
+        const auto path {dir_ / (key + suffix)};
+        std::error_code ec;
+        std::filesystem::rename(temp, path, ec);
+        if (ec) {
+            std::filesystem::remove(temp, ec);
+            return;
+        }
+
+        std::lock_guard lock {mutex_};
+        if (!scanned_) {
+            // The scan counts the new entry too.
+            total_bytes_ = 0;
+            for (const auto& entry : list_entries()) {
+                total_bytes_ += entry.size;
+            }
+            scanned_ = true;
+        } else if (struct stat st {}; ::stat(path.c_str(), &st) == 0) {
+            total_bytes_ += disk_size(st);
+        }
+        if (total_bytes_ > max_bytes_) {
+            evict();
+        }
+    }
+
+private:
+    static constexpr const char* suffix {".result"};
+
+    struct Entry {
+        std::filesystem::path path;
+        // Disk space, see disk_size().
+        uint64_t size;
+        // The mtime, in nanoseconds.
+        int64_t used;
+    };
+
+    // Space the file takes on disk: whole blocks, however small the entry.
+    static uint64_t disk_size(const struct stat& st) {
+        return static_cast<uint64_t>(st.st_blocks) * 512;
+    }
+
+    std::vector<Entry> list_entries() const {
+        std::vector<Entry> entries;
+        std::error_code ec;
+        for (const auto& item : std::filesystem::directory_iterator {dir_, ec}) {
+            struct stat st {};
+            if (item.path().extension() != suffix || ::stat(item.path().c_str(), &st) != 0) {
+                continue;
+            }
+            const auto used {int64_t{st.st_mtim.tv_sec} * 1000000000 + st.st_mtim.tv_nsec};
+            entries.push_back({item.path(), disk_size(st), used});
+        }
+        return entries;
+    }
+
+    /*
+     * Removes the least recently used entries until the directory is back
+     * under 3/4 of the bound, so the directory isn't rescanned on every store.
+     */
+    void evict() {
+        auto entries {list_entries()};
+        std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+            return a.used < b.used;
+        });
+        total_bytes_ = 0;
+        for (const auto& entry : entries) {
+            total_bytes_ += entry.size;
+        }
+        const auto target {max_bytes_ / 4 * 3};
+        for (const auto& entry : entries) {
+            if (total_bytes_ <= target) {
+                break;
+            }
+            std::error_code ec;
+            std::filesystem::remove(entry.path, ec);
+            total_bytes_ -= entry.size;
+        }
+    }
+
+    std::filesystem::path dir_;
+    uint64_t max_bytes_;
+    bool ok_ {false};
+    std::atomic<uint64_t> hits_ {0};
+    std::atomic<uint64_t> misses_ {0};
+    std::mutex mutex_;
+    // Disk space of the entries as of the last scan, plus stores since;
+    // unknown until the first store scans.
+    uint64_t total_bytes_ {0};
+    bool scanned_ {false};
+};
+
+/*
+ * Prints the result of "filename" from the cache of "options", or computes it
+ * with parse() and solve() and stores it under the version tag "solver" (see
+ * ResultCache::key). The file is read once: parse() gets the very bytes that
+ * were hashed, so the key always matches what was solved, and pipes and FIFOs
+ * work too. The hit and miss counts go to stderr, then the phases recorded in
+ * "stats". Returns the process exit code.
+ */
+template <typename Input>
+int solve_cached(const CacheOptions& options, std::string_view solver, const std::string& filename,
+                 bool (*parse)(std::string_view, Input&, std::string&),
+                 const std::function<std::string(Input&)>& solve, stats::Recorder& stats) {
+    ResultCache cache {options};
+    if (!cache.ok()) {
+        std::cerr << "Error: could not use the cache directory '" << options.dir << "'.\n";
+        return 1;
+    }
+
+    auto map_phase {stats.phase("map")};
+    const FileBuffer file {filename};
+    if (!file.ok()) {
+        std::cerr << "Error: could not read or parse '" << filename << "'.\n";
+        return 1;
+    }
+    map_phase.stop();
+
+    auto hash_phase {stats.phase("hash")};
+    const auto key {ResultCache::key(solver, file.view())};
+    hash_phase.stop();
+
+    auto lookup_phase {stats.phase("lookup")};
+    std::string output;
+    const auto hit {cache.lookup(key, output)};
+    lookup_phase.stop();
+
+    if (!hit) {
+        Input input;
+        std::string error;
+        auto parse_phase {stats.phase("parse")};
+        if (!parse(file.view(), input, error)) {
+            std::cerr << error << "\n";
+            return 1;
+        }
+        parse_phase.stop();
+        {
+            const auto solve_phase {stats.phase("solve")};
+            output = solve(input);
+        }
+        const auto store_phase {stats.phase("store")};
+        cache.store(key, output);
+    }
+
+    std::cout << output;
+    std::cerr << "Cache: " << cache.hits() << " hits, " << cache.misses() << " misses.\n";
+    stats.report();
+    return 0;
+}
+
+}  // namespace aoc
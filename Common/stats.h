@@ -0,0 +1,281 @@
+/*
+ * Per-phase instrumentation shared by the days.
+ *
+ * A Recorder times named phases (parse, sort, scan, output, ...) with scoped
+ * timers and, on Linux, reads hardware counters around them: cycles,
+ * instructions, cache misses and branch misses. The summary goes to stderr,
+ * as a table or as JSON, so the results on stdout are unchanged.
+ *
+ * A disabled Recorder hands out empty scopes: no clock reads, no system
+ * calls, nothing recorded.
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace aoc::stats {
+
+constexpr size_t counter_count {4};
+constexpr std::array<std::string_view, counter_count> counter_names {
+    "cycles", "instructions", "cache_misses", "branch_misses"};
+
+/*
+ * The hardware counters of this process, including the threads it starts
+ * later. Opening fails quietly where perf events are unavailable (other
+ * systems, containers, a strict perf_event_paranoid); available() then
+ * returns false and read() returns zeros.
+ */
+class Counters {
+public:
+    Counters() = default;
+
+    ~Counters() {
+        close();
+    }
+
+    Counters(const Counters&) = delete;
+    Counters& operator=(const Counters&) = delete;
+
+    // Returns true if every counter could be opened.
+    bool open() {
+#if defined(__linux__)
+        constexpr std::array<uint64_t, counter_count> configs {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+        for (size_t i = 0; i < counter_count; ++i) {
+            perf_event_attr attr {};
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = configs[i];
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.inherit = 1;
+            fds_[i] = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+            if (fds_[i] < 0) {
+                close();
+                return false;
+            }
+        }
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    bool available() const {
+        return fds_[0] >= 0;
+    }
+
+    std::array<uint64_t, counter_count> read() const {
+        std::array<uint64_t, counter_count> values {};
+#if defined(__linux__)
+        for (size_t i = 0; i < counter_count && available(); ++i) {
+            if (::read(fds_[i], &values[i], sizeof(values[i])) != static_cast<ssize_t>(sizeof(values[i]))) {
+                values[i] = 0;
+            }
+        }
+#endif
+        return values;
+    }
+
+private:
+    void close() {
+#if defined(__linux__)
+        for (auto& fd : fds_) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+            fd = -1;
+        }
+#endif
+    }
+
+    std::array<int, counter_count> fds_ {-1, -1, -1, -1};
+};
+
+enum class Format {
+    table,
+    json
+};
+
+struct Phase {
+    std::string name;
+    double seconds {0};
+    std::array<uint64_t, counter_count> counts {};
+};
+
+class Recorder {
+public:
+    /*
+     * Times one phase from construction to stop() or destruction. A phase
+     * that runs several times (e.g. once per chunk) adds up under its name.
+     */
+    class Scope {
+    public:
+        Scope(Recorder* recorder, std::string_view name) : recorder_ {recorder} {
+            if (recorder_) {
+                name_ = name;
+                start_counts_ = recorder_->counters_.read();
+                start_ = std::chrono::steady_clock::now();
+            }
+        }
+
+        ~Scope() {
+            stop();
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        void stop() {
+            if (!recorder_) {
+                return;
+            }
+            const auto seconds {std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count()};
+            auto counts {recorder_->counters_.read()};
+            for (size_t i = 0; i < counter_count; ++i) {
+                counts[i] -= start_counts_[i];
+            }
+            recorder_->add(name_, seconds, counts);
+            recorder_ = nullptr;
+        }
+
+    private:
+        Recorder* recorder_;
+        std::string_view name_;
+        std::chrono::steady_clock::time_point start_;
+        std::array<uint64_t, counter_count> start_counts_ {};
+    };
+
+    Recorder() = default;
+
+    Recorder(const Recorder&) = delete;
+    Recorder& operator=(const Recorder&) = delete;
+
+    /*
+     * Enables the recorder on "--stats" (table) or "--stats=json".
+     * Returns false if "arg" is neither, so callers can chain it with their
+     * own flags.
+     */
+    bool parse_flag(std::string_view arg) {
+        if (arg == "--stats") {
+            enable(Format::table);
+        } else if (arg == "--stats=json") {
+            enable(Format::json);
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    void enable(Format format) {
+        enabled_ = true;
+        format_ = format;
+        counters_.open();
+    }
+
+    bool enabled() const {
+        return enabled_;
+    }
+
+    // "name" must outlive the scope; string literals are the usual choice.
+    [[nodiscard]] Scope phase(std::string_view name) {
+        return Scope {enabled_ ? this : nullptr, name};
+    }
+
+    // Prints the phases in the order they first ran, if enabled.
+    void report(std::ostream& out = std::cerr) const {
+        if (!enabled_) {
+            return;
+        }
+        if (format_ == Format::json) {
+            report_json(out);
+        } else {
+            report_table(out);
+        }
+    }
+
+private:
+    void add(std::string_view name, double seconds, const std::array<uint64_t, counter_count>& counts) {
+        auto it {phases_.begin()};
+        while (it != phases_.end() && it->name != name) {
+            ++it;
+        }
+        if (it == phases_.end()) {
+            phases_.push_back({std::string {name}, 0, {}});
+            it = phases_.end() - 1;
+        }
+        it->seconds += seconds;
+        for (size_t i = 0; i < counter_count; ++i) {
+            it->counts[i] += counts[i];
+        }
+    }
+
+    void report_table(std::ostream& out) const {
+        const auto flags {out.flags()};
+        out << std::left << std::setw(12) << "phase" << std::right << std::setw(12) << "ms";
+        if (counters_.available()) {
+            for (const auto name : counter_names) {
+                out << std::setw(16) << name;
+            }
+            out << std::setw(8) << "IPC";
+        }
+        out << "\n";
+        for (const auto& phase : phases_) {
+            out << std::left << std::setw(12) << phase.name << std::right << std::setw(12)
+                << std::fixed << std::setprecision(3) << phase.seconds * 1e3;
+            if (counters_.available()) {
+                for (const auto count : phase.counts) {
+                    out << std::setw(16) << count;
+                }
+                out << std::setw(8) << std::setprecision(2) << ipc(phase);
+            }
+            out << "\n";
+        }
+        if (!counters_.available()) {
+            out << "(hardware counters unavailable)\n";
+        }
+        out.flags(flags);
+    }
+
+    void report_json(std::ostream& out) const {
+        out << "{\"counters\":" << (counters_.available() ? "true" : "false") << ",\"phases\":[";
+        for (size_t p = 0; p < phases_.size(); ++p) {
+            const auto& phase {phases_[p]};
+            out << (p ? "," : "") << "{\"name\":\"" << phase.name << "\",\"ms\":" << phase.seconds * 1e3;
+            if (counters_.available()) {
+                for (size_t i = 0; i < counter_count; ++i) {
+                    out << ",\"" << counter_names[i] << "\":" << phase.counts[i];
+                }
+                out << ",\"ipc\":" << ipc(phase);
+            }
+            out << "}";
+        }
+        out << "]}\n";
+    }
+
+    static double ipc(const Phase& phase) {
+        return phase.counts[0] ? static_cast<double>(phase.counts[1]) / static_cast<double>(phase.counts[0]) : 0.0;
+    }
+
+    bool enabled_ {false};
+    Format format_ {Format::table};
+    Counters counters_;
+    std::vector<Phase> phases_;
+};
+
+}  // namespace aoc::stats
@@ -0,0 +1,162 @@
+/*
+ * Thread pool shared by the days, and their "--threads N" flag.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace aoc {
+
+/* Fixed-size thread pool with one task deque per worker.
+ * Submitted tasks are dealt round-robin; a worker pops its own deque from
+ * the back and, once it runs dry, steals from the front of the others, so
+ * uneven chunks even out without a single contended queue.
+ */
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(unsigned threads) : queues_(std::max(threads, 1u)) {
+        workers_.reserve(queues_.size());
+        for (size_t i = 0; i < queues_.size(); ++i) {
+            workers_.emplace_back([this, i] { run(i); });
+        }
+    }
+
+    ~WorkStealingPool() {
+        {
+            std::lock_guard lock {mutex_};
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    void submit(std::function<void()> task) {
+        auto& queue {queues_[next_queue_++ % queues_.size()]};
+        {
+            // Counted before it can be popped: otherwise a worker could pop
+            // and finish it first, underflowing queued_ or letting wait()
+            // see no pending work while it is queued.
+            std::lock_guard lock {mutex_};
+            ++queued_;
+            ++pending_;
+            std::lock_guard queue_lock {queue.mutex};
+            queue.tasks.push_back(std::move(task));
+        }
+        wake_.notify_one();
+    }
+
+    // Blocks until every submitted task has finished.
+    void wait() {
+        std::unique_lock lock {mutex_};
+        done_.wait(lock, [this] { return pending_ == 0; });
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    bool try_pop(size_t self, std::function<void()>& task) {
+        for (size_t k = 0; k < queues_.size(); ++k) {
+            auto& queue {queues_[(self + k) % queues_.size()]};
+            std::lock_guard lock {queue.mutex};
+            if (queue.tasks.empty()) {
+                continue;
+            }
+            // Own work LIFO (still warm in cache), stolen work FIFO.
+            if (k == 0) {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            } else {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+            return true;
+        }
+        return false;
+    }
+
+    void run(size_t self) {
+        while (true) {
+            std::function<void()> task;
+            if (try_pop(self, task)) {
+                {
+                    std::lock_guard lock {mutex_};
+                    --queued_;
+                }
+                task();
+                std::lock_guard lock {mutex_};
+                if (--pending_ == 0) {
+                    done_.notify_all();
+                }
+                continue;
+            }
+
+            std::unique_lock lock {mutex_};
+            wake_.wait(lock, [this] { return stopping_ || queued_ > 0; });
+            if (stopping_ && queued_ == 0) {
+                return;
+            }
+        }
+    }
+
+    std::vector<Queue> queues_;
+    std::vector<std::thread> workers_;
+    // Tasks may submit further tasks, from any worker.
+    std::atomic<size_t> next_queue_ {0};
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    // Tasks sitting in a deque, and tasks not yet finished.
+    size_t queued_ {0};
+    size_t pending_ {0};
+    bool stopping_ {false};
+};
+
+/*
+ * The "--threads N" flag: worker threads, defaulting to the hardware
+ * concurrency.
+ */
+struct ThreadOptions {
+    unsigned count {std::max(std::thread::hardware_concurrency(), 1u)};
+    // Set when the flag had an invalid value, which has been reported.
+    bool invalid {false};
+
+    /*
+     * Consumes "--threads N" at argv[i], advancing "i".
+     * Returns false if argv[i] is not that flag.
+     */
+    bool parse_flag(int argc, char* argv[], int& i) {
+        if (i + 1 >= argc || std::string_view {argv[i]} != "--threads") {
+            return false;
+        }
+        const std::string_view value {argv[++i]};
+        const auto [_, ec] = std::from_chars(value.data(), value.data() + value.size(), count);
+        if (ec != std::errc() || count == 0) {
+            std::cerr << "Invalid thread count '" << value << "'.\n";
+            invalid = true;
+        }
+        return true;
+    }
+};
+
+}  // namespace aoc
@@ -0,0 +1,1188 @@
+/*
+ * Day 1: Historian Hysteria
+ *
+ * Part 1: Compute the total distance between a given left list and a given right 
+ * list, add up the distances between all of the pairs you found. 
+ * 
+ * Part 2: Calculate a total similarity score by adding up each number in the left 
+ * list after multiplying it by the number of times that number appears in the right list.
+ * 
+ * Please, refer to historian_hysteria.txt to read the full assignment.
+*/
+
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <charconv>
+#include <cstdint>
+#include <bit>
+#include <filesystem>
+#include <queue>
+#include <memory>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../Common/file_buffer.h"
+#include "../Common/parse.h"
+#include "../Common/result_cache.h"
+#include "../Common/stats.h"
+#include "../Common/thread_pool.h"
+#include "day1.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define DAY1_X86_DISPATCH 1
+#endif
+
+
+namespace day1 {
+
+/*
+ * Checks that both lists hold the same, non-zero number of entries.
+ * Returns the error to report, or nullptr.
+ */
+const char* check_list_sizes(uint64_t left_count, uint64_t right_count) {
+    if (left_count == 0) {
+        return "Left list is empty.";
+    }
+    if (right_count == 0) {
+        return "Right list is empty.";
+    }
+    if (left_count != right_count) {
+        return "Mismatched number of entries in the input file.";
+    }
+    return nullptr;
+}
+
+/*
+ * Reads pairs of ints from "text" into "left" and "right".
+ * Like the stream loader, parsing stops at the first token that is not a
+ * number and an unpaired trailing value is dropped.
+ */
+void parse_pairs(std::string_view text,
+                 std::vector<int>& left,
+                 std::vector<int>& right)
+{
+    // One pair per line: the newline count gives the exact capacity.
+    const auto lines {aoc::count_lines(text)};
+    left.clear();
+    left.reserve(lines);
+    right.clear();
+    right.reserve(lines);
+
+    const char* p {text.data()};
+    const char* const end {p + text.size()};
+    while (true) {
+        int ll, rl;
+        p = aoc::skip_spaces(p, end);
+        if (!aoc::parse_int(p, end, ll)) {
+            break;
+        }
+        p = aoc::skip_spaces(p, end);
+        if (!aoc::parse_int(p, end, rl)) {
+            break;
+        }
+        left.push_back(ll);
+        right.push_back(rl);
+    }
+}
+
+/*
+ * Reads the pairs of "filename" by memory-mapping the file and parsing it
+ * in place. Returns true on success.
+ */
+bool parse_input_mmap(const std::string& filename,
+                      std::vector<int>& left,
+                      std::vector<int>& right)
+{
+    const aoc::FileBuffer file {filename};
+    if (!file.ok()) {
+        return false;
+    }
+    parse_pairs(file.view(), left, right);
+    return true;
+}
+
+/*
+ * Reads pairs of ints from "filename" into "left" and "right".
+ * Returns true on success.
+ */
+bool parse_input_stream(const std::string& filename,
+                std::vector<int>& left,
+                std::vector<int>& right)
+{
+    std::ifstream input{filename};
+    if(!input) {
+        return false;
+    }
+    
+    // To reserve the exact amount of needed space, a
+    // preliminary line-count pass would be needed.
+    left.clear();
+    left.reserve(100000); 
+    right.clear();
+    right.reserve(100000);
+
+    int ll, rl;
+    while (input >> ll >> rl) {
+      left.push_back(ll);
+      right.push_back(rl);
+    }
+
+    if (input.bad()) {
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * Sorting strategy picked from the observed value range of a list.
+ */
+enum class SortMethod {
+    comparison, // std::sort, for lists too short to amortize a histogram.
+    counting,   // One histogram over a dense range.
+    radix8,     // LSD radix sort with 8-bit digits.
+    radix11,    // LSD radix sort with 11-bit digits.
+    radix16     // LSD radix sort with 16-bit digits.
+};
+
+/*
+ * Picks a method for "n" values spanning "range" (max - min).
+ * A counting sort wins when the histogram is no larger than a few times
+ * the list. Otherwise the digit width minimizing the number of radix passes
+ * is used, preferring the narrower digit on ties since its histogram stays
+ * in L1. 16-bit digits are only worth their 256 KiB histogram on long lists.
+ */
+SortMethod choose_sort_method(size_t n, uint64_t range) {
+    if (n < 256) {
+        return SortMethod::comparison;
+    }
+    if (range < (uint64_t{1} << 24) && range <= 4 * static_cast<uint64_t>(n)) {
+        return SortMethod::counting;
+    }
+
+    unsigned bits {1};
+    while (bits < 32 && (range >> bits) != 0) {
+        ++bits;
+    }
+    const auto passes = [bits](unsigned digit_bits) {
+        return (bits + digit_bits - 1) / digit_bits;
+    };
+
+    auto method {SortMethod::radix8};
+    if (passes(11) < passes(8)) {
+        method = SortMethod::radix11;
+    }
+    if (n >= (size_t{1} << 20) && passes(16) < passes(11)) {
+        method = SortMethod::radix16;
+    }
+    return method;
+}
+
+// Offset of "v" from "min" as an unsigned key; never overflows.
+uint32_t sort_key(int v, int min) {
+    return static_cast<uint32_t>(v) - static_cast<uint32_t>(min);
+}
+
+/*
+ * Sorts "values" (all in [min, min + range]) by counting occurrences.
+ */
+void counting_sort(std::vector<int>& values, int min, uint64_t range) {
+    std::vector<uint32_t> counts(range + 1, 0);
+    for (const auto v : values) {
+        ++counts[sort_key(v, min)];
+    }
+
+    auto out {values.begin()};
+    for (uint64_t key = 0; key <= range; ++key) {
+        out = std::fill_n(out, counts[key], static_cast<int>(min + static_cast<int64_t>(key)));
+    }
+}
+
+/*
+ * LSD radix sort of "values" on the keys (v - min), "digit_bits" at a time.
+ * "buffer" is the scratch space the passes ping-pong with.
+ * Passes where every key shares the same digit are skipped.
+ */
+void radix_sort(std::vector<int>& values, std::vector<int>& buffer,
+                int min, uint64_t range, unsigned digit_bits) {
+    const auto n {values.size()};
+    const size_t radix {size_t{1} << digit_bits};
+    const uint32_t mask {static_cast<uint32_t>(radix - 1)};
+    buffer.resize(n);
+    std::vector<size_t> offsets(radix);
+
+    auto* src {&values};
+    auto* dst {&buffer};
+    for (unsigned shift = 0; shift < 32 && (range >> shift) != 0; shift += digit_bits) {
+        std::fill(offsets.begin(), offsets.end(), 0);
+        for (const auto v : *src) {
+            ++offsets[(sort_key(v, min) >> shift) & mask];
+        }
+        // Everything lands in one bucket: this digit doesn't reorder anything.
+        if (std::find(offsets.begin(), offsets.end(), n) != offsets.end()) {
+            continue;
+        }
+        std::exclusive_scan(offsets.begin(), offsets.end(), offsets.begin(), size_t{0});
+
+        auto& out {*dst};
+        for (const auto v : *src) {
+            out[offsets[(sort_key(v, min) >> shift) & mask]++] = v;
+        }
+        std::swap(src, dst);
+    }
+
+    // After an odd number of passes the sorted data sits in the scratch buffer.
+    if (src != &values) {
+        values.swap(buffer);
+    }
+}
+
+/*
+ * Sorts "values" with the method chosen from their observed range,
+ * using "buffer" as working space. Returns the method used.
+ */
+SortMethod sort_values(std::vector<int>& values, std::vector<int>& buffer) {
+    if (values.empty()) {
+        return SortMethod::comparison;
+    }
+
+    const auto [min_it, max_it] = std::minmax_element(values.begin(), values.end());
+    const auto min {*min_it};
+    const auto range {static_cast<uint64_t>(static_cast<int64_t>(*max_it) - min)};
+
+    const auto method {choose_sort_method(values.size(), range)};
+    switch (method) {
+        case SortMethod::comparison:
+            std::sort(values.begin(), values.end());
+            break;
+        case SortMethod::counting:
+            counting_sort(values, min, range);
+            break;
+        case SortMethod::radix8:
+            radix_sort(values, buffer, min, range, 8);
+            break;
+        case SortMethod::radix11:
+            radix_sort(values, buffer, min, range, 11);
+            break;
+        case SortMethod::radix16:
+            radix_sort(values, buffer, min, range, 16);
+            break;
+    }
+    return method;
+}
+
+/*
+ * Sorts "left" and "right", each with its own working buffer. With more than
+ * one thread they are sorted concurrently, "left" on a one-worker pool and
+ * "right" on the calling thread; with one (e.g. a job of the all-days
+ * runner, already on a pool worker) both are sorted on the calling thread.
+ */
+void sort_lists(std::vector<int>& left, std::vector<int>& right,
+                std::vector<int>& left_buffer, std::vector<int>& right_buffer, unsigned threads) {
+    if (threads <= 1) {
+        sort_values(left, left_buffer);
+        sort_values(right, right_buffer);
+        return;
+    }
+    aoc::WorkStealingPool pool {1};
+    pool.submit([&] { sort_values(left, left_buffer); });
+    sort_values(right, right_buffer);
+    pool.wait();
+}
+
+void sort_lists(std::vector<int>& left, std::vector<int>& right, unsigned threads) {
+    std::vector<int> left_buffer, right_buffer;
+    sort_lists(left, right, left_buffer, right_buffer, threads);
+}
+
+/*
+ * Sum of |l[i] - r[i]| over [0, n). Every kernel widens to 64-bit lanes
+ * before subtracting, so no difference of two ints can overflow.
+ */
+using DistanceKernel = long long (*)(const int* l, const int* r, size_t n);
+
+long long distance_kernel_scalar(const int* l, const int* r, size_t n) {
+    auto sum {0ll};
+    for (size_t i = 0; i < n; ++i) {
+        sum += std::llabs(static_cast<long long>(l[i]) - static_cast<long long>(r[i]));
+    }
+    return sum;
+}
+
+#if defined(DAY1_X86_DISPATCH)
+__attribute__((target("sse4.2")))
+long long distance_kernel_sse42(const int* l, const int* r, size_t n) {
+    auto acc {_mm_setzero_si128()};
+    const auto zero {_mm_setzero_si128()};
+    size_t i {0};
+    for (; i + 2 <= n; i += 2) {
+        const auto lv {_mm_cvtepi32_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(l + i)))};
+        const auto rv {_mm_cvtepi32_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(r + i)))};
+        const auto d {_mm_sub_epi64(lv, rv)};
+        // |d| = (d ^ sign) - sign, with sign all-ones for negative lanes.
+        const auto sign {_mm_cmpgt_epi64(zero, d)};
+        acc = _mm_add_epi64(acc, _mm_sub_epi64(_mm_xor_si128(d, sign), sign));
+    }
+    alignas(16) long long lanes[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    return lanes[0] + lanes[1] + distance_kernel_scalar(l + i, r + i, n - i);
+}
+
+__attribute__((target("avx2")))
+long long distance_kernel_avx2(const int* l, const int* r, size_t n) {
+    auto acc {_mm256_setzero_si256()};
+    const auto zero {_mm256_setzero_si256()};
+    size_t i {0};
+    for (; i + 4 <= n; i += 4) {
+        const auto lv {_mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(l + i)))};
+        const auto rv {_mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(r + i)))};
+        const auto d {_mm256_sub_epi64(lv, rv)};
+        const auto sign {_mm256_cmpgt_epi64(zero, d)};
+        acc = _mm256_add_epi64(acc, _mm256_sub_epi64(_mm256_xor_si256(d, sign), sign));
+    }
+    alignas(32) long long lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] +
+        distance_kernel_scalar(l + i, r + i, n - i);
+}
+#endif
+
+/*
+ * Picks the widest kernel the running CPU supports, so a single binary
+ * built for baseline x86-64 still uses AVX2 where it is available.
+ */
+DistanceKernel select_distance_kernel() {
+#if defined(DAY1_X86_DISPATCH)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return distance_kernel_avx2;
+    }
+    if (__builtin_cpu_supports("sse4.2")) {
+        return distance_kernel_sse42;
+    }
+#endif
+    return distance_kernel_scalar;
+}
+
+/*
+ * Part 1 over sorted lists: the vectors are split into contiguous chunks,
+ * each reduced by the dispatched kernel on a work-stealing pool. Chunks are
+ * kept large enough that short lists stay on the calling thread.
+ */
+long long compute_total_distance(const std::vector<int>& left,
+                                 const std::vector<int>& right,
+                                 unsigned threads = 1) {
+    static const auto kernel {select_distance_kernel()};
+    constexpr size_t min_chunk {size_t{1} << 16};
+
+    const auto n {std::min(left.size(), right.size())};
+    const auto chunks {std::clamp<size_t>(n / min_chunk, 1, std::max(threads, 1u))};
+    const auto chunk_size {(n + chunks - 1) / chunks};
+
+    if (chunks == 1) {
+        return kernel(left.data(), right.data(), n);
+    }
+
+    std::vector<long long> partial(chunks, 0);
+    {
+        aoc::WorkStealingPool pool {static_cast<unsigned>(chunks)};
+        for (size_t c = 0; c < chunks; ++c) {
+            pool.submit([&, c] {
+                const auto begin {std::min(n, c * chunk_size)};
+                const auto end {std::min(n, begin + chunk_size)};
+                partial[c] = kernel(left.data() + begin, right.data() + begin, end - begin);
+            });
+        }
+        pool.wait();
+    }
+
+    return std::accumulate(partial.begin(), partial.end(), 0ll);
+}
+
+long long compute_similarity_score(const std::vector<int>& left,
+                                   const std::vector<int>& right) {
+    size_t i {0}, j {0};
+    auto similarity_score {0ll};
+    // Continue until one list is fully traversed.
+    while (i < left.size() && j < right.size()) {
+        // left[i] can’t match anything in right.
+        if (left[i] < right[j]) {
+            ++i;
+            continue;
+        }
+        // right[i] can’t match anything in left.
+        if (left[i] > right[j]) {
+            ++j;
+            continue;
+        }
+        if (left[i] == right[j]) {
+            auto freq {0};
+            // Count how many times "left[i]" repeats in right[...]
+            while((j < right.size()) && (left[i] == right[j])) {
+                ++freq;
+                ++j;
+            }
+            // Every copy of "left[i]" in left scores the same frequency.
+            const auto value {left[i]};
+            while ((i < left.size()) && (left[i] == value)) {
+                similarity_score+=static_cast<long long>(value) * freq;
+                ++i;
+            }
+        }
+    }
+    
+    return  similarity_score;
+}
+
+/*
+ * Open-addressing frequency table: key -> number of occurrences.
+ * Keys and counts are interleaved so a probe touches a single cache line,
+ * and linear probing keeps collisions in that line too.
+ * A zero count marks an empty slot.
+ */
+class FrequencyTable {
+public:
+    // Sized for "max_keys" distinct keys at a load factor of at most 1/2.
+    explicit FrequencyTable(size_t max_keys)
+        : slots_(std::bit_ceil(std::max<size_t>(2 * max_keys, 16))),
+          mask_ {slots_.size() - 1} {}
+
+    void add(int key) {
+        auto i {slot_index(key)};
+        while (slots_[i].count != 0 && slots_[i].key != key) {
+            i = (i + 1) & mask_;
+        }
+        slots_[i].key = key;
+        ++slots_[i].count;
+    }
+
+    uint32_t count(int key) const {
+        auto i {slot_index(key)};
+        while (slots_[i].count != 0) {
+            if (slots_[i].key == key) {
+                return slots_[i].count;
+            }
+            i = (i + 1) & mask_;
+        }
+        return 0;
+    }
+
+    static size_t bytes_for(size_t max_keys) {
+        return std::bit_ceil(std::max<size_t>(2 * max_keys, 16)) * sizeof(Slot);
+    }
+
+private:
+    struct Slot {
+        int key {0};
+        uint32_t count {0};
+    };
+
+    // Fibonacci hashing: the high bits of the product are well mixed.
+    size_t slot_index(int key) const {
+        const auto h {static_cast<uint64_t>(static_cast<uint32_t>(key)) * 0x9E3779B97F4A7C15ull};
+        return static_cast<size_t>(h >> 32) & mask_;
+    }
+
+    std::vector<Slot> slots_;
+    size_t mask_;
+};
+
+/*
+ * Part 2 without sorting: counts "right" into a hash table, then streams
+ * "left" against it. O(n) expected, and neither list has to be ordered.
+ */
+long long compute_similarity_score_hashed(const std::vector<int>& left,
+                                          const std::vector<int>& right,
+                                          size_t max_keys) {
+    FrequencyTable frequencies {max_keys};
+    for (const auto r : right) {
+        frequencies.add(r);
+    }
+
+    auto similarity_score {0ll};
+    for (const auto l : left) {
+        similarity_score += static_cast<long long>(l) * frequencies.count(l);
+    }
+    return similarity_score;
+}
+
+enum class SimilarityPath {
+    hash_table, // compute_similarity_score_hashed
+    merge_scan  // compute_similarity_score over sorted lists
+};
+
+const char* to_string(SimilarityPath path) {
+    return path == SimilarityPath::hash_table ? "hash table" : "merge scan";
+}
+
+/*
+ * Picks the Part 2 engine. Already-sorted lists make the merge scan a
+ * single linear pass, so it always wins then. Otherwise the hash table is
+ * used as long as it stays cache-sized; the distinct keys are bounded by both
+ * the list length and the key range. Past that point random probes miss
+ * memory on every access, and sorting (streaming) plus merging is cheaper.
+ */
+SimilarityPath choose_similarity_path(size_t n, uint64_t range, bool sorted) {
+    constexpr size_t hash_table_budget {32u << 20};
+    if (sorted) {
+        return SimilarityPath::merge_scan;
+    }
+    const auto max_keys {static_cast<size_t>(std::min<uint64_t>(n, range + 1))};
+    return FrequencyTable::bytes_for(max_keys) <= hash_table_budget
+        ? SimilarityPath::hash_table
+        : SimilarityPath::merge_scan;
+}
+
+/*
+ * Temporary file holding sorted runs of ints back to back.
+ * The file is unlinked as soon as it is created, so it never outlives
+ * the process, and all runs of a column share a single descriptor.
+ */
+class RunFile {
+public:
+    // A run as [offset, offset + count) in elements.
+    struct Run {
+        uint64_t offset;
+        uint64_t count;
+    };
+
+    explicit RunFile(const std::filesystem::path& dir) {
+        auto pattern {(dir / "day1-runs-XXXXXX").string()};
+        fd_ = ::mkstemp(pattern.data());
+        if (fd_ >= 0) {
+            ::unlink(pattern.c_str());
+        }
+    }
+
+    ~RunFile() {
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+
+    RunFile(const RunFile&) = delete;
+    RunFile& operator=(const RunFile&) = delete;
+
+    bool ok() const { return fd_ >= 0; }
+    int fd() const { return fd_; }
+    const std::vector<Run>& runs() const { return runs_; }
+
+    // Appends "values" to the file. Returns false on a write error.
+    bool write(const int* values, size_t count) {
+        auto bytes {reinterpret_cast<const char*>(values)};
+        auto remaining {count * sizeof(int)};
+        auto offset {static_cast<off_t>(size_ * sizeof(int))};
+        while (remaining > 0) {
+            const auto written {::pwrite(fd_, bytes, remaining, offset)};
+            if (written <= 0) {
+                return false;
+            }
+            bytes += written;
+            offset += written;
+            remaining -= static_cast<size_t>(written);
+        }
+        size_ += count;
+        return true;
+    }
+
+    // Closes the run made of everything written since the previous one.
+    void end_run() {
+        const auto begin {runs_.empty() ? 0 : runs_.back().offset + runs_.back().count};
+        if (size_ > begin) {
+            runs_.push_back({begin, size_ - begin});
+        }
+    }
+
+private:
+    int fd_ {-1};
+    uint64_t size_ {0};
+    std::vector<Run> runs_;
+};
+
+/*
+ * Sequential reader over one run, refilled "buffer_size" elements at a time.
+ */
+class RunReader {
+public:
+    RunReader(int fd, RunFile::Run run, size_t buffer_size)
+        : fd_ {fd}, next_offset_ {run.offset}, remaining_ {run.count},
+          buffer_(std::max<size_t>(buffer_size, 1)) {}
+
+    // Reads the next value. Returns false at the end of the run or on error.
+    bool next(int& value) {
+        if (pos_ == filled_ && !refill()) {
+            return false;
+        }
+        value = buffer_[pos_++];
+        return true;
+    }
+
+    bool failed() const { return failed_; }
+
+private:
+    bool refill() {
+        const auto count {static_cast<size_t>(std::min<uint64_t>(remaining_, buffer_.size()))};
+        if (count == 0) {
+            return false;
+        }
+        auto bytes {reinterpret_cast<char*>(buffer_.data())};
+        auto wanted {count * sizeof(int)};
+        auto offset {static_cast<off_t>(next_offset_ * sizeof(int))};
+        while (wanted > 0) {
+            const auto got {::pread(fd_, bytes, wanted, offset)};
+            if (got <= 0) {
+                failed_ = true;
+                return false;
+            }
+            bytes += got;
+            offset += got;
+            wanted -= static_cast<size_t>(got);
+        }
+        next_offset_ += count;
+        remaining_ -= count;
+        pos_ = 0;
+        filled_ = count;
+        return true;
+    }
+
+    int fd_;
+    uint64_t next_offset_;
+    uint64_t remaining_;
+    std::vector<int> buffer_;
+    size_t pos_ {0};
+    size_t filled_ {0};
+    bool failed_ {false};
+};
+
+/*
+ * k-way merge of the runs [first, last) of "file" through a min-heap.
+ */
+class RunMerger {
+public:
+    RunMerger(const RunFile& file, size_t first, size_t last, size_t buffer_size) {
+        readers_.reserve(last - first);
+        for (auto i = first; i < last; ++i) {
+            readers_.emplace_back(file.fd(), file.runs()[i], buffer_size);
+            int value;
+            if (readers_.back().next(value)) {
+                heap_.push({value, readers_.size() - 1});
+            }
+        }
+    }
+
+    // Pops the smallest remaining value. Returns false once all runs are drained.
+    bool next(int& value) {
+        if (heap_.empty()) {
+            return false;
+        }
+        const auto [smallest, reader] = heap_.top();
+        heap_.pop();
+        value = smallest;
+        int following;
+        if (readers_[reader].next(following)) {
+            heap_.push({following, reader});
+        }
+        return true;
+    }
+
+    bool failed() const {
+        return std::any_of(readers_.begin(), readers_.end(),
+                           [](const RunReader& reader) { return reader.failed(); });
+    }
+
+private:
+    using Entry = std::pair<int, size_t>;
+    std::vector<RunReader> readers_;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap_;
+};
+
+/*
+ * Streaming mode settings. The budget bounds the buffers this mode
+ * allocates; it is split between the sort chunks and the merge readers.
+ */
+struct StreamingConfig {
+    size_t memory_budget {size_t{256} << 20};
+    std::filesystem::path temp_dir {std::filesystem::temp_directory_path()};
+};
+
+// Smallest merge read buffer, in elements; bounds the merge fan-in.
+constexpr size_t min_merge_buffer {1024};
+
+/*
+ * Phase 1 of the streaming mode: reads "filename" in bounded chunks, sorts
+ * each chunk of pairs (on "threads" threads, see sort_lists) and appends it
+ * to "left_runs"/"right_runs".
+ * Parsing follows the in-memory loaders: it stops at the first token that is
+ * not a number and an unpaired trailing value is dropped. A token split by a
+ * read is carried into the next one, up to "max_token_length" bytes so the
+ * read buffer stays within the budget.
+ * Returns false on a read or write error or a token over the limit.
+ */
+bool write_sorted_runs(const std::string& filename, const StreamingConfig& config, unsigned threads,
+                       RunFile& left_runs, RunFile& right_runs,
+                       uint64_t& left_count, uint64_t& right_count) {
+    const auto fd {::open(filename.c_str(), O_RDONLY)};
+    if (fd < 0) {
+        return false;
+    }
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    // Far beyond any number, which is at most 11 characters.
+    constexpr size_t max_token_length {4096};
+    // Per pair: both values, plus for each list the larger of a radix
+    // scratch slot (4 bytes) and a counting sort histogram share (16 bytes).
+    constexpr size_t bytes_per_pair {2 * (sizeof(int) + 16)};
+    const auto read_size {std::clamp<size_t>(config.memory_budget / 16, 4096, size_t{1} << 20)};
+    const auto text_size {read_size + max_token_length};
+    const auto chunk_pairs {std::max<size_t>(
+        (config.memory_budget - std::min(config.memory_budget, text_size)) / bytes_per_pair, 1024)};
+
+    std::vector<int> left, right, left_buffer, right_buffer;
+    left.reserve(chunk_pairs);
+    right.reserve(chunk_pairs);
+    left_count = 0;
+    right_count = 0;
+
+    const auto flush = [&] {
+        if (left.empty()) {
+            return true;
+        }
+        sort_lists(left, right, left_buffer, right_buffer, threads);
+        if (!left_runs.write(left.data(), left.size()) ||
+            !right_runs.write(right.data(), right.size())) {
+            return false;
+        }
+        left_runs.end_run();
+        right_runs.end_run();
+        left_count += left.size();
+        right_count += right.size();
+        left.clear();
+        right.clear();
+        return true;
+    };
+
+    // Holds the unparsed tail of the previous read plus the next read.
+    std::vector<char> text(text_size);
+    size_t carried {0};
+    auto at_eof {false};
+    auto stopped {false};
+    auto ok {true};
+    while (ok && !stopped && !at_eof) {
+        const auto got {::read(fd, text.data() + carried, read_size)};
+        if (got < 0) {
+            ok = false;
+            break;
+        }
+        at_eof = (got == 0);
+        const auto filled {carried + static_cast<size_t>(got)};
+
+        // Unless at EOF, the last token may continue in the next read:
+        // only parse up to the last whitespace byte.
+        auto limit {filled};
+        if (!at_eof) {
+            while (limit > 0 && !aoc::is_space(text[limit - 1])) {
+                --limit;
+            }
+        }
+
+        const char* p {text.data()};
+        const char* const end {text.data() + limit};
+        while (true) {
+            p = aoc::skip_spaces(p, end);
+            if (p == end) {
+                break;
+            }
+            int value;
+            if (!aoc::parse_int(p, end, value)) {
+                stopped = true;
+                break;
+            }
+            if (left.size() == right.size()) {
+                left.push_back(value);
+            } else {
+                right.push_back(value);
+                if (right.size() == chunk_pairs && !flush()) {
+                    ok = false;
+                    break;
+                }
+            }
+        }
+
+        carried = filled - limit;
+        if (carried > max_token_length) {
+            std::cerr << "Token longer than " << max_token_length << " bytes.\n";
+            ok = false;
+            break;
+        }
+        std::memmove(text.data(), text.data() + limit, carried);
+    }
+    ::close(fd);
+
+    if (left.size() > right.size()) {
+        left.pop_back();
+    }
+    return ok && flush();
+}
+
+/*
+ * Merges groups of runs until at most "fan_in" remain, so the final merge
+ * stays within the budget whatever the number of chunks. "runs" is replaced
+ * by the file holding the merged runs.
+ * Returns true on success.
+ */
+bool reduce_runs(std::unique_ptr<RunFile>& runs, const StreamingConfig& config, size_t fan_in) {
+    while (runs->runs().size() > fan_in) {
+        auto merged {std::make_unique<RunFile>(config.temp_dir)};
+        if (!merged->ok()) {
+            return false;
+        }
+        // k readers plus the output buffer share the budget.
+        const auto buffer_size {config.memory_budget / sizeof(int) / (fan_in + 1)};
+        std::vector<int> out;
+        out.reserve(buffer_size);
+
+        const auto total {runs->runs().size()};
+        for (size_t first = 0; first < total; first += fan_in) {
+            RunMerger merger {*runs, first, std::min(total, first + fan_in), buffer_size};
+            int value;
+            while (merger.next(value)) {
+                out.push_back(value);
+                if (out.size() == buffer_size) {
+                    if (!merged->write(out.data(), out.size())) {
+                        return false;
+                    }
+                    out.clear();
+                }
+            }
+            if (merger.failed() || !merged->write(out.data(), out.size())) {
+                return false;
+            }
+            out.clear();
+            merged->end_run();
+        }
+        runs = std::move(merged);
+    }
+    return true;
+}
+
+struct StreamingResult {
+    long long total_distance {0};
+    long long similarity_score {0};
+};
+
+/*
+ * Phase 2 of the streaming mode: k-way merges both columns and walks the two
+ * sorted streams together by value, computing both parts in a single pass.
+ *
+ * For two sorted lists of equal length, the sum of |left[i] - right[i]|
+ * equals the sum over every integer x of |#{left <= x} - #{right <= x}|.
+ * Between two consecutive distinct values both counts are constant, so
+ * Part 1 only needs the running counts, just like Part 2 only needs how many
+ * times each value occurs in either list.
+ * Returns true on success.
+ */
+bool merge_and_score(std::unique_ptr<RunFile>& left_runs, std::unique_ptr<RunFile>& right_runs,
+                     const StreamingConfig& config, StreamingResult& result) {
+    // Each column gets half of the budget for its read buffers.
+    const auto fan_in {std::max<size_t>(config.memory_budget / 2 / sizeof(int) / min_merge_buffer, 2)};
+    if (!reduce_runs(left_runs, config, fan_in) || !reduce_runs(right_runs, config, fan_in)) {
+        return false;
+    }
+
+    const auto buffer_size = [&](const RunFile& runs) {
+        return config.memory_budget / 2 / sizeof(int) / std::max<size_t>(runs.runs().size(), 1);
+    };
+    RunMerger left {*left_runs, 0, left_runs->runs().size(), buffer_size(*left_runs)};
+    RunMerger right {*right_runs, 0, right_runs->runs().size(), buffer_size(*right_runs)};
+
+    int l, r;
+    auto has_left {left.next(l)};
+    auto has_right {right.next(r)};
+    long long left_seen {0}, right_seen {0};
+    long long previous {0};
+    auto first {true};
+    result = {};
+    while (has_left || has_right) {
+        const auto value {(has_left && (!has_right || l <= r)) ? l : r};
+        if (!first) {
+            result.total_distance += std::llabs(left_seen - right_seen) * (value - previous);
+        }
+
+        long long left_freq {0}, right_freq {0};
+        while (has_left && l == value) {
+            ++left_freq;
+            has_left = left.next(l);
+        }
+        while (has_right && r == value) {
+            ++right_freq;
+            has_right = right.next(r);
+        }
+
+        result.similarity_score += static_cast<long long>(value) * left_freq * right_freq;
+        left_seen += left_freq;
+        right_seen += right_freq;
+        previous = value;
+        first = false;
+    }
+
+    return !left.failed() && !right.failed();
+}
+
+// The result lines, shared by solve() and every print path of cli_main.
+std::string part1_line(long long total_distance) {
+    return "Result Part 1 (Total Distance): " + std::to_string(total_distance) + "\n";
+}
+
+std::string part2_line(long long similarity_score) {
+    return "Result Part 2 (Similarity Score): " + std::to_string(similarity_score) + "\n";
+}
+
+bool parse(std::string_view text, Input& input, std::string& error) {
+    parse_pairs(text, input.left, input.right);
+    if (const auto size_error {check_list_sizes(input.left.size(), input.right.size())}) {
+        error = size_error;
+        return false;
+    }
+    return true;
+}
+
+std::string solve(Input& input, unsigned threads) {
+    sort_lists(input.left, input.right, threads);
+    const auto total_distance {compute_total_distance(input.left, input.right, threads)};
+    const auto similarity_score {compute_similarity_score(input.left, input.right)};
+    return part1_line(total_distance) + part2_line(similarity_score);
+}
+
+struct Options {
+    // The stream loader is kept to cross-check the mmap one.
+    bool use_mmap {true};
+    // std::sort is kept as the reference for the range-based sorts.
+    bool use_std_sort {false};
+    bool part1 {true};
+    bool part2 {true};
+    // Report the engine choices on stderr.
+    bool verbose {false};
+    aoc::ThreadOptions threads;
+    // Bounded-memory external sort instead of loading both lists.
+    bool streaming {false};
+    StreamingConfig streaming_config;
+    aoc::CacheOptions cache;
+};
+
+/*
+ * Parses the flags following the input file into "options", and --stats
+ * into "stats". Returns false on an unknown or invalid flag.
+ */
+bool parse_options(int argc, char* argv[], Options& options, aoc::stats::Recorder& stats) {
+    for (int i = 2; i < argc; ++i) {
+        const std::string_view arg {argv[i]};
+        if (stats.parse_flag(arg) || options.threads.parse_flag(argc, argv, i) ||
+            options.cache.parse_flag(argc, argv, i)) {
+            continue;
+        } else if (arg == "--loader=mmap") {
+            options.use_mmap = true;
+        } else if (arg == "--loader=stream") {
+            options.use_mmap = false;
+        } else if (arg == "--sort=auto") {
+            options.use_std_sort = false;
+        } else if (arg == "--sort=std") {
+            options.use_std_sort = true;
+        } else if (arg == "--part=1") {
+            options.part1 = true;
+            options.part2 = false;
+        } else if (arg == "--part=2") {
+            options.part1 = false;
+            options.part2 = true;
+        } else if (arg == "--part=all") {
+            options.part1 = true;
+            options.part2 = true;
+        } else if (arg == "--verbose") {
+            options.verbose = true;
+        } else if (arg == "--streaming") {
+            options.streaming = true;
+        } else if (arg == "--memory-budget" && i + 1 < argc) {
+            const std::string_view value {argv[++i]};
+            size_t mebibytes {0};
+            const auto [_, ec] = std::from_chars(value.data(), value.data() + value.size(), mebibytes);
+            if (ec != std::errc() || mebibytes == 0) {
+                std::cerr << "Invalid memory budget '" << value << "'.\n";
+                return false;
+            }
+            options.streaming_config.memory_budget = mebibytes << 20;
+        } else if (arg == "--temp-dir" && i + 1 < argc) {
+            options.streaming_config.temp_dir = argv[++i];
+        } else {
+            std::cerr << "Unknown option '" << arg << "'.\n";
+            return false;
+        }
+    }
+    return !options.threads.invalid && !options.cache.invalid;
+}
+
+/*
+ * Runs both parts through the external merge sort.
+ * Returns the process exit code.
+ */
+int run_streaming(const std::string& filename, const Options& options, aoc::stats::Recorder& stats) {
+    const auto& config {options.streaming_config};
+    auto left_runs {std::make_unique<RunFile>(config.temp_dir)};
+    auto right_runs {std::make_unique<RunFile>(config.temp_dir)};
+    if (!left_runs->ok() || !right_runs->ok()) {
+        std::cerr << "Error: could not create temporary files in '" << config.temp_dir.string() << "'.\n";
+        return 1;
+    }
+
+    uint64_t left_count {0}, right_count {0};
+    auto runs_phase {stats.phase("runs")};
+    if (!write_sorted_runs(filename, config, options.threads.count, *left_runs, *right_runs,
+                           left_count, right_count)) {
+        std::cerr << "Error: could not read or parse '" << filename << "'.\n";
+        return 1;
+    }
+
+    if (const auto error {check_list_sizes(left_count, right_count)}) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+
+    runs_phase.stop();
+
+    StreamingResult result;
+    auto merge_phase {stats.phase("merge")};
+    if (!merge_and_score(left_runs, right_runs, config, result)) {
+        std::cerr << "Error: could not merge the sorted runs.\n";
+        return 1;
+    }
+    merge_phase.stop();
+
+    auto output_phase {stats.phase("output")};
+    if (options.part1) {
+        std::cout << part1_line(result.total_distance);
+    }
+    if (options.part2) {
+        std::cout << part2_line(result.similarity_score);
+    }
+    output_phase.stop();
+
+    stats.report();
+    return 0;
+}
+
+int cli_main(int argc, char* argv[]) {
+
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <input-file> [--loader=mmap|stream]"
+                     " [--sort=auto|std] [--part=1|2|all] [--threads N] [--verbose]"
+                     " [--streaming [--memory-budget MiB] [--temp-dir DIR]]"
+                     " [--cache DIR [--cache-size MiB]] [--stats[=json]].\n";
+        return 1;
+    }
+
+    Options options;
+    aoc::stats::Recorder stats;
+    if (!parse_options(argc, argv, options, stats)) {
+        return 1;
+    }
+
+    if (options.cache.enabled()) {
+        // Cached results are the two-part lines of solve().
+        if (options.streaming || !options.part1 || !options.part2) {
+            std::cerr << "--cache can't be combined with --streaming or --part.\n";
+            return 1;
+        }
+        return aoc::solve_cached<Input>(options.cache, solver_version, argv[1], parse,
+                                        [&](Input& input) { return solve(input, options.threads.count); },
+                                        stats);
+    }
+
+    if (options.streaming) {
+        return run_streaming(argv[1], options, stats);
+    }
+
+    std::vector<int> left, right;
+    auto parse_phase {stats.phase("parse")};
+    const auto parsed {options.use_mmap ? parse_input_mmap(argv[1], left, right)
+                                : parse_input_stream(argv[1], left, right)};
+    if (!parsed) {
+        std::cerr << "Error: could not read or parse '" << argv[1] << "'.\n";
+        return 1;
+    }
+
+    if (const auto error {check_list_sizes(left.size(), right.size())}) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    parse_phase.stop();
+
+    const auto sort_both = [&] {
+        const auto sort_phase {stats.phase("sort")};
+        if (options.use_std_sort) {
+            std::sort(left.begin(), left.end());
+            std::sort(right.begin(), right.end());
+        } else {
+            sort_lists(left, right, options.threads.count);
+        }
+    };
+    auto sorted {false};
+
+    // Results are printed together at the end, in the "output" phase.
+    auto total_distance {0ll};
+    auto similarity_score {0ll};
+
+    // Part 1
+    if (options.part1) {
+        sort_both();
+        sorted = true;
+        const auto distance_phase {stats.phase("distance")};
+        total_distance = compute_total_distance(left, right, options.threads.count);
+    }
+
+    // Part 2
+    if (options.part2) {
+        const auto [min_it, max_it] = std::minmax_element(right.begin(), right.end());
+        const auto range {static_cast<uint64_t>(static_cast<int64_t>(*max_it) - *min_it)};
+        const auto path {choose_similarity_path(right.size(), range, sorted)};
+        if (options.verbose) {
+            std::cerr << "Part 2 path: " << to_string(path) << "\n";
+        }
+
+        if (path == SimilarityPath::hash_table) {
+            const auto similarity_phase {stats.phase("similarity")};
+            const auto max_keys {static_cast<size_t>(std::min<uint64_t>(right.size(), range + 1))};
+            similarity_score = compute_similarity_score_hashed(left, right, max_keys);
+        } else {
+            if (!sorted) {
+                sort_both();
+            }
+            const auto similarity_phase {stats.phase("similarity")};
+            similarity_score = compute_similarity_score(left, right);
+        }
+    }
+
+    auto output_phase {stats.phase("output")};
+    if (options.part1) {
+        std::cout << part1_line(total_distance);
+    }
+    if (options.part2) {
+        std::cout << part2_line(similarity_score);
+    }
+    output_phase.stop();
+
+    stats.report();
+    return 0;
+}
+
+}  // namespace day1
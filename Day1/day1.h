@@ -0,0 +1,27 @@
+/*
+ * Day 1: Historian Hysteria, the solver's interface (implemented in day1.cpp).
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace day1 {
+
+inline constexpr std::string_view solver_version {"day1-v1"};
+
+struct Input {
+    std::vector<int> left, right;
+};
+
+// Reads both lists of "text" and checks they are the same length.
+bool parse(std::string_view text, Input& input, std::string& error);
+
+// Sorts the lists and returns the result lines of both parts.
+std::string solve(Input& input, unsigned threads = 1);
+
+int cli_main(int argc, char* argv[]);
+
+}  // namespace day1
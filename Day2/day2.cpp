@@ -0,0 +1,881 @@
+/*
+ * Day 2: Red-Nosed Reports
+ *
+ * Part 1: Find safe reports. A report only counts as safe if both of the following are true:
+ *
+ *  - The levels are either all increasing or all decreasing;
+ *  - Any two adjacent levels differ by at least one and at most three.
+ *
+ * Part 2: Update the previous task by handling situations where you can remove a single level 
+ * from unsafe reports.
+ * 
+ * Please, refer to red-nosed_reports.txt to read the full assignment.
+*/
+
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <array>
+#include <span>
+#include <optional>
+#include <charconv>
+#include <random>
+#include <cstdint>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <iomanip>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../Common/file_buffer.h"
+#include "../Common/parse.h"
+#include "../Common/result_cache.h"
+#include "../Common/stats.h"
+#include "../Common/thread_pool.h"
+#include "day2.h"
+
+
+namespace day2 {
+
+bool is_distance_ok(int distance) {
+    return std::abs(distance) > 0 && std::abs(distance) <= 3; 
+}
+
+bool is_increment_ok(int distance)
+{
+    return distance > 0;
+}
+
+/* Checks if a sequence of levels is "safe".
+ * Optionally skips one index to simulate removal. 
+ */
+bool is_safe(std::span<const int> levels, std::optional<size_t> skip=std::nullopt) {
+
+    auto distance_ok {true};
+    // Tracks if all steps so far are non-decreasing.
+    auto increment_ok {true}; 
+    // Tracks if all steps so far are non-increasing.
+    auto decrement_ok {true};
+    
+    for (size_t i = 0; i < levels.size() - 1; ++i) {
+        /// Skip this index if specified
+        if (skip.has_value() && *skip==i) {
+            continue;
+        }
+
+        const auto left_level {levels[i]};
+        auto right_level {levels[i + 1]};
+        // If the skip refers to the next index "i + 1", jump ahead.
+        if (skip.has_value() && (*skip - 1) == i)  {
+            // If the jump would take us to the vector end, break.
+            if((i + 2) == levels.size()) {
+                break;
+            }    
+            right_level = levels[i + 2];
+        }
+        
+        const auto d = right_level - left_level;
+        
+        // If distance rule fails, report unsafe immediately.
+        if (!is_distance_ok(d)) { distance_ok = false; break; }
+        // Track monotonicity: if any step is not an increment, mark "increasing_ok" as false.
+        if (!is_increment_ok(d)) { increment_ok = false; }
+        // if any step is not a decrement, mark "decreasing_ok" as false.
+        if (is_increment_ok(d)) { decrement_ok = false; }
+    }
+    // Safe if all distances ok AND either fully non-decreasing or non-increasing.
+    return (distance_ok && (increment_ok || decrement_ok)); 
+}
+
+/* Finds the first index where the report becomes unsafe under original rules.
+ * Returns std::nullopt if the report is safe as-is.
+ */
+std::optional<size_t> find_first_failing_index(std::span<const int> levels) {
+
+    auto increment_ok {true};
+    auto decrement_ok {true};
+
+    for (size_t i = 0; i < levels.size() - 1; ++i) {
+        size_t first_bad_level = i;
+
+        auto d = levels[i + 1] - levels[i]; 
+        if (!is_increment_ok(d)) { increment_ok = false;}
+        if (is_increment_ok(d)) { decrement_ok = false;}
+
+        // If either distance rule or monotonicity breaks, return failure index.
+        if (!is_distance_ok(d) || (!increment_ok && !decrement_ok)) {
+            return first_bad_level;
+        }
+    }
+
+    return std::nullopt;    
+}
+
+/* Verdict of check_safety: whether a report is safe as-is, safe once
+ * "removed" is dropped, or unsafe either way.
+ */
+enum class Safety { safe, safe_with_removal, unsafe };
+
+struct SafetyVerdict {
+    Safety safety;
+    std::optional<size_t> removed;
+};
+
+/* Decides Part 1 and Part 2 for a report in one forward pass.
+ *
+ * Each direction hypothesis (increasing, decreasing) runs a small state
+ * machine; after reading levels[i] it tracks whether the prefix can be made
+ * safe and with what last kept level:
+ *  - clean:   nothing removed, last kept is levels[i];
+ *  - kept:    one level removed earlier, last kept is levels[i];
+ *  - dropped: levels[i] itself removed, last kept is levels[i - 1].
+ * A step only ever compares the new level against levels[i] or levels[i - 1].
+ */
+SafetyVerdict check_safety(std::span<const int> levels) {
+    struct Hypothesis {
+        bool clean {true};
+        bool kept {false};
+        size_t kept_removed {0};
+        // Removing levels[0] leaves nothing to compare the next level against.
+        bool dropped {true};
+    };
+
+    const auto step_ok = [](bool increasing, int from, int to) {
+        const auto d {to - from};
+        return is_distance_ok(d) && (is_increment_ok(d) == increasing);
+    };
+
+    Hypothesis hypotheses[2];
+    for (size_t i = 0; i + 1 < levels.size(); ++i) {
+        const auto next {levels[i + 1]};
+        auto alive {false};
+        for (auto h = 0; h < 2; ++h) {
+            const auto increasing {h == 0};
+            auto& state {hypotheses[h]};
+
+            Hypothesis following;
+            following.clean = state.clean && step_ok(increasing, levels[i], next);
+            following.kept = false;
+            if (state.kept && step_ok(increasing, levels[i], next)) {
+                following.kept = true;
+                following.kept_removed = state.kept_removed;
+            } else if (state.dropped && (i == 0 || step_ok(increasing, levels[i - 1], next))) {
+                following.kept = true;
+                following.kept_removed = i;
+            }
+            following.dropped = state.clean;
+
+            state = following;
+            alive = alive || state.clean || state.kept || state.dropped;
+        }
+        if (!alive) {
+            return {Safety::unsafe, std::nullopt};
+        }
+    }
+
+    for (const auto& state : hypotheses) {
+        if (state.clean) {
+            return {Safety::safe, std::nullopt};
+        }
+    }
+    for (const auto& state : hypotheses) {
+        if (state.kept) {
+            return {Safety::safe_with_removal, state.kept_removed};
+        }
+        if (state.dropped) {
+            return {Safety::safe_with_removal, levels.size() - 1};
+        }
+    }
+    return {Safety::unsafe, std::nullopt};
+}
+
+/* Reference Part 2 check: the first failing index and its two neighbours
+ * are each tried as the removed level.
+ */
+bool is_safe_with_removal(std::span<const int> levels) {
+    if (is_safe(levels)) {
+        return true;
+    }
+    const auto first_failing_index = *find_first_failing_index(levels);
+    return is_safe(levels, first_failing_index - 1) ||
+           is_safe(levels, first_failing_index) ||
+           is_safe(levels, first_failing_index + 1);
+}
+
+/* Differential test of check_safety against is_safe/is_safe_with_removal on
+ * "reports" random reports. Random reports are mostly unsafe, so half of
+ * them are built as near-monotonic walks with an occasional bad step.
+ * Returns the number of disagreements.
+ */
+size_t run_differential_test(size_t reports, unsigned seed) {
+    std::mt19937 rng {seed};
+    std::uniform_int_distribution<int> length {2, 10};
+    std::uniform_int_distribution<int> level {0, 12};
+    std::uniform_int_distribution<int> step {1, 3};
+    std::uniform_int_distribution<int> glitch {-5, 5};
+    std::uniform_int_distribution<int> percent {0, 99};
+
+    size_t mismatches {0};
+    std::vector<int> levels, reduced;
+    for (size_t t = 0; t < reports; ++t) {
+        levels.resize(length(rng));
+        if (t % 2 == 0) {
+            for (auto& value : levels) {
+                value = level(rng);
+            }
+        } else {
+            const auto direction {percent(rng) < 50 ? 1 : -1};
+            levels[0] = level(rng);
+            for (size_t i = 1; i < levels.size(); ++i) {
+                levels[i] = levels[i - 1] + (percent(rng) < 85 ? direction * step(rng) : glitch(rng));
+            }
+        }
+
+        const auto verdict {check_safety(levels)};
+        const auto expected_safe {is_safe(levels)};
+        const auto expected_fixable {is_safe_with_removal(levels)};
+
+        auto agrees {(verdict.safety == Safety::safe) == expected_safe &&
+                     (verdict.safety != Safety::unsafe) == expected_fixable};
+        // The reported index must actually fix the report.
+        if (agrees && verdict.safety == Safety::safe_with_removal) {
+            reduced.assign(levels.begin(), levels.end());
+            reduced.erase(reduced.begin() + static_cast<std::ptrdiff_t>(*verdict.removed));
+            agrees = reduced.size() < 2 || is_safe(reduced);
+        }
+
+        if (!agrees) {
+            if (++mismatches <= 10) {
+                std::cerr << "Mismatch on report:";
+                for (const auto value : levels) {
+                    std::cerr << ' ' << value;
+                }
+                std::cerr << "\n";
+            }
+        }
+    }
+    return mismatches;
+}
+
+/*
+ * Levels of one report. The first "inline_capacity" levels live inside the
+ * object, so typical reports never touch the heap; longer ones spill into
+ * a vector that is kept (and reused) across reports.
+ */
+class LevelBuffer {
+public:
+    static constexpr size_t inline_capacity {32};
+
+    void clear() {
+        size_ = 0;
+        spill_.clear();
+    }
+
+    void push_back(int value) {
+        if (size_ < inline_capacity) {
+            inline_[size_] = value;
+        } else {
+            if (size_ == inline_capacity) {
+                spill_.assign(inline_.begin(), inline_.end());
+            }
+            spill_.push_back(value);
+        }
+        ++size_;
+    }
+
+    size_t size() const { return size_; }
+
+    std::span<const int> view() const {
+        if (size_ <= inline_capacity) {
+            return {inline_.data(), size_};
+        }
+        return {spill_.data(), spill_.size()};
+    }
+
+private:
+    std::array<int, inline_capacity> inline_ {};
+    std::vector<int> spill_;
+    size_t size_ {0};
+};
+
+/*
+ * Parses the whitespace-separated levels of "line" into "levels", in place.
+ * As with stream extraction, parsing stops at the first token that is not
+ * a number.
+ */
+void parse_levels(std::string_view line, LevelBuffer& levels) {
+    levels.clear();
+    const char* p {line.data()};
+    const char* const end {p + line.size()};
+    while (true) {
+        p = aoc::skip_spaces(p, end);
+        int value;
+        if (!aoc::parse_int(p, end, value)) {
+            return;
+        }
+        levels.push_back(value);
+    }
+}
+
+/* Part 1 and Part 2 tallies over a set of reports. */
+struct SafeCounts {
+    uint64_t reports {0};
+    uint64_t safe {0};
+    uint64_t safe_with_removal {0};
+
+    void add(Safety safety) {
+        ++reports;
+        // A safe report is also safe for Part 2.
+        safe += (safety == Safety::safe);
+        safe_with_removal += (safety != Safety::unsafe);
+    }
+
+    void merge(const SafeCounts& other) {
+        reports += other.reports;
+        safe += other.safe;
+        safe_with_removal += other.safe_with_removal;
+    }
+};
+
+/* Calls "visit" with every line of "text", without the '\n'. */
+template <typename Visit>
+void for_each_line(std::string_view text, Visit&& visit) {
+    size_t line_start {0};
+    while (line_start < text.size()) {
+        const auto* newline {static_cast<const char*>(
+            std::memchr(text.data() + line_start, '\n', text.size() - line_start))};
+        const auto line_end {newline ? static_cast<size_t>(newline - text.data()) : text.size()};
+        visit(text.substr(line_start, line_end - line_start));
+        line_start = line_end + 1;
+    }
+}
+
+/* Evaluates the reports in "text" one at a time. */
+SafeCounts count_reports_rowwise(std::string_view text) {
+    LevelBuffer report_levels;
+    SafeCounts counts;
+    for_each_line(text, [&](std::string_view report) {
+        parse_levels(report, report_levels);
+        // Need at least two levels to compare.
+        if (report_levels.size() >= 2) {
+            counts.add(check_safety(report_levels.view()).safety);
+        }
+    });
+    return counts;
+}
+
+/* Reports in columnar (CSR) form: the levels of every report back to back,
+ * report r spanning levels[offsets[r]] .. levels[offsets[r + 1] - 1].
+ * Levels are narrowed to 16 bits so a SIMD register holds 8 of them.
+ */
+struct ReportStore {
+    // Any two stored levels differ by less than 2^15, so deltas fit in 16 bits too.
+    static constexpr int min_level {-(1 << 14)};
+    static constexpr int max_level {(1 << 14) - 1};
+
+    std::vector<int16_t> levels;
+    std::vector<size_t> offsets {0};
+
+    size_t size() const { return offsets.size() - 1; }
+};
+
+/* Loads every report of "text" with at least two levels into "store".
+ * Returns false if a level falls outside the 16-bit range of the store.
+ */
+bool load_reports(std::string_view text, ReportStore& store) {
+    LevelBuffer report_levels;
+    auto fits {true};
+    // Text needs at least two bytes per level.
+    store.levels.reserve(text.size() / 2);
+    for_each_line(text, [&](std::string_view report) {
+        if (!fits) {
+            return;
+        }
+        parse_levels(report, report_levels);
+        if (report_levels.size() < 2) {
+            return;
+        }
+        for (const auto value : report_levels.view()) {
+            if (value < ReportStore::min_level || value > ReportStore::max_level) {
+                fits = false;
+                return;
+            }
+            store.levels.push_back(static_cast<int16_t>(value));
+        }
+        store.offsets.push_back(store.levels.size());
+    });
+    return fits;
+}
+
+/* Bitsets over the flat level array: bit k is set when the step
+ * levels[k] -> levels[k + 1] is not a valid increase (or decrease).
+ * Steps crossing from one report into the next are computed too and
+ * simply never looked at.
+ */
+struct StepMasks {
+    std::vector<uint64_t> bad_increase;
+    std::vector<uint64_t> bad_decrease;
+};
+
+StepMasks compute_step_masks(const std::vector<int16_t>& levels) {
+    const auto steps {levels.empty() ? 0 : levels.size() - 1};
+    StepMasks masks;
+    masks.bad_increase.assign(steps / 64 + 1, 0);
+    masks.bad_decrease.assign(steps / 64 + 1, 0);
+
+    size_t k {0};
+#if defined(__SSE2__)
+    // 16 steps per iteration, as two vectors of 8 16-bit deltas.
+    const auto zero {_mm_setzero_si128()};
+    const auto four {_mm_set1_epi16(4)};
+    const auto minus_four {_mm_set1_epi16(-4)};
+    for (; k + 16 <= steps; k += 16) {
+        const auto* base {levels.data() + k};
+        const auto d_low {_mm_sub_epi16(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(base + 1)),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(base)))};
+        const auto d_high {_mm_sub_epi16(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(base + 9)),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(base + 8)))};
+
+        // 1 <= d <= 3 and -3 <= d <= -1, one 0/-1 lane per step.
+        const auto inc_low {_mm_and_si128(_mm_cmpgt_epi16(d_low, zero), _mm_cmplt_epi16(d_low, four))};
+        const auto inc_high {_mm_and_si128(_mm_cmpgt_epi16(d_high, zero), _mm_cmplt_epi16(d_high, four))};
+        const auto dec_low {_mm_and_si128(_mm_cmplt_epi16(d_low, zero), _mm_cmpgt_epi16(d_low, minus_four))};
+        const auto dec_high {_mm_and_si128(_mm_cmplt_epi16(d_high, zero), _mm_cmpgt_epi16(d_high, minus_four))};
+
+        // Narrow the lanes to bytes so movemask yields one bit per step.
+        const auto inc_ok {static_cast<uint64_t>(_mm_movemask_epi8(_mm_packs_epi16(inc_low, inc_high)))};
+        const auto dec_ok {static_cast<uint64_t>(_mm_movemask_epi8(_mm_packs_epi16(dec_low, dec_high)))};
+        // k is a multiple of 16, so the 16 bits never straddle two words.
+        masks.bad_increase[k / 64] |= (~inc_ok & 0xFFFFu) << (k % 64);
+        masks.bad_decrease[k / 64] |= (~dec_ok & 0xFFFFu) << (k % 64);
+    }
+#endif
+    for (; k < steps; ++k) {
+        const auto d {levels[k + 1] - levels[k]};
+        const auto bit {uint64_t{1} << (k % 64)};
+        if (!(is_distance_ok(d) && is_increment_ok(d))) {
+            masks.bad_increase[k / 64] |= bit;
+        }
+        if (!(is_distance_ok(d) && !is_increment_ok(d))) {
+            masks.bad_decrease[k / 64] |= bit;
+        }
+    }
+    return masks;
+}
+
+/* True if no bit of "bits" in [first, last) is set. */
+bool none_set(const std::vector<uint64_t>& bits, size_t first, size_t last) {
+    if (first >= last) {
+        return true;
+    }
+    const auto first_word {first / 64};
+    const auto last_word {(last - 1) / 64};
+    const auto low_mask {~uint64_t{0} << (first % 64)};
+    const auto high_mask {~uint64_t{0} >> (63 - (last - 1) % 64)};
+    if (first_word == last_word) {
+        return (bits[first_word] & low_mask & high_mask) == 0;
+    }
+    if ((bits[first_word] & low_mask) != 0 || (bits[last_word] & high_mask) != 0) {
+        return false;
+    }
+    for (auto w = first_word + 1; w < last_word; ++w) {
+        if (bits[w] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Evaluates a whole store at once: Part 1 reads the SIMD step masks,
+ * and only the reports failing it go through check_safety for Part 2.
+ */
+SafeCounts count_reports_batched(const ReportStore& store) {
+    const auto masks {compute_step_masks(store.levels)};
+    SafeCounts counts;
+    std::array<int, LevelBuffer::inline_capacity> inline_levels;
+    std::vector<int> long_levels;
+    for (size_t r = 0; r < store.size(); ++r) {
+        const auto first {store.offsets[r]};
+        const auto last {store.offsets[r + 1]};
+        // The steps of a report are [first, last - 1).
+        if (none_set(masks.bad_increase, first, last - 1) ||
+            none_set(masks.bad_decrease, first, last - 1)) {
+            counts.add(Safety::safe);
+            continue;
+        }
+
+        const auto length {last - first};
+        int* widened {inline_levels.data()};
+        if (length > inline_levels.size()) {
+            long_levels.resize(length);
+            widened = long_levels.data();
+        }
+        std::copy(store.levels.begin() + first, store.levels.begin() + last, widened);
+        counts.add(check_safety({widened, length}).safety);
+    }
+    return counts;
+}
+
+/* Splits "text" into pieces of about "target_size" bytes, each ending
+ * right after a '\n' (or at the end of the text), so no report is cut.
+ */
+std::vector<std::string_view> split_lines(std::string_view text, size_t target_size) {
+    std::vector<std::string_view> chunks;
+    size_t begin {0};
+    while (begin < text.size()) {
+        auto end {std::min(text.size(), begin + target_size)};
+        if (end < text.size()) {
+            const auto newline {text.find('\n', end - 1)};
+            end = (newline == std::string_view::npos) ? text.size() : newline + 1;
+        }
+        chunks.push_back(text.substr(begin, end - begin));
+        begin = end;
+    }
+    return chunks;
+}
+
+/* Evaluates the reports of "text" with the chosen engine. The columnar
+ * engine needs levels that fit its 16-bit store; anything else takes the
+ * row-wise path.
+ */
+SafeCounts count_reports(std::string_view text, bool use_batch) {
+    if (use_batch) {
+        ReportStore store;
+        if (load_reports(text, store)) {
+            return count_reports_batched(store);
+        }
+    }
+    return count_reports_rowwise(text);
+}
+
+/* Evaluates "text" as newline-aligned chunks on a work-stealing pool.
+ * Each chunk is counted into its own slot and the slots are summed in
+ * order, so the result doesn't depend on scheduling.
+ */
+SafeCounts count_reports_parallel(std::string_view text, bool use_batch, unsigned threads) {
+    // Several chunks per thread let the pool balance uneven chunks.
+    constexpr size_t min_chunk {size_t{1} << 20};
+    const auto target {std::max(min_chunk, text.size() / (size_t{threads} * 8) + 1)};
+    const auto chunks {split_lines(text, target)};
+
+    if (threads <= 1 || chunks.size() <= 1) {
+        return count_reports(text, use_batch);
+    }
+
+    std::vector<SafeCounts> partial(chunks.size());
+    {
+        aoc::WorkStealingPool pool {threads};
+        for (size_t c = 0; c < chunks.size(); ++c) {
+            pool.submit([&, c] { partial[c] = count_reports(chunks[c], use_batch); });
+        }
+        pool.wait();
+    }
+
+    SafeCounts counts;
+    for (const auto& part : partial) {
+        counts.merge(part);
+    }
+    return counts;
+}
+
+/* Reads a descriptor on a background thread into two fixed buffers, so
+ * the next block is being read while the current one is processed.
+ * Works on pipes and FIFOs, and memory stays at two buffers however
+ * long the stream runs.
+ */
+class DoubleBufferedReader {
+public:
+    enum class Status { block, idle, end };
+
+    DoubleBufferedReader(int fd, size_t buffer_size)
+        : fd_ {fd}, buffers_ {std::vector<char>(buffer_size), std::vector<char>(buffer_size)},
+          reader_ {[this] { run(); }} {}
+
+    ~DoubleBufferedReader() {
+        {
+            std::lock_guard lock {mutex_};
+            stopping_ = true;
+        }
+        changed_.notify_all();
+        reader_.join();
+    }
+
+    DoubleBufferedReader(const DoubleBufferedReader&) = delete;
+    DoubleBufferedReader& operator=(const DoubleBufferedReader&) = delete;
+
+    /* Hands out the next filled block through "block", releasing the
+     * previous one. Gives up with Status::idle after "timeout" without
+     * data, and returns Status::end once the stream is drained.
+     */
+    Status next(std::string_view& block, std::chrono::steady_clock::duration timeout) {
+        std::unique_lock lock {mutex_};
+        if (handed_out_) {
+            filled_[consumer_] = 0;
+            consumer_ ^= 1;
+            handed_out_ = false;
+            changed_.notify_all();
+        }
+        const auto ready = [this] { return filled_[consumer_] > 0 || at_end_; };
+        if (!changed_.wait_for(lock, timeout, ready)) {
+            return Status::idle;
+        }
+        if (filled_[consumer_] == 0) {
+            return Status::end;
+        }
+        block = {buffers_[consumer_].data(), filled_[consumer_]};
+        handed_out_ = true;
+        return Status::block;
+    }
+
+    bool failed() const {
+        std::lock_guard lock {mutex_};
+        return failed_;
+    }
+
+private:
+    void run() {
+        size_t producer {0};
+        while (true) {
+            {
+                std::unique_lock lock {mutex_};
+                changed_.wait(lock, [&] { return stopping_ || filled_[producer] == 0; });
+                if (stopping_) {
+                    return;
+                }
+            }
+            // The consumer never touches a buffer whose size is 0.
+            const auto got {::read(fd_, buffers_[producer].data(), buffers_[producer].size())};
+            std::lock_guard lock {mutex_};
+            if (got <= 0) {
+                failed_ = (got < 0);
+                at_end_ = true;
+                changed_.notify_all();
+                return;
+            }
+            filled_[producer] = static_cast<size_t>(got);
+            producer ^= 1;
+            changed_.notify_all();
+        }
+    }
+
+    int fd_;
+    std::vector<char> buffers_[2];
+    size_t filled_[2] {0, 0};
+    size_t consumer_ {0};
+    bool handed_out_ {false};
+    bool at_end_ {false};
+    bool failed_ {false};
+    bool stopping_ {false};
+
+    mutable std::mutex mutex_;
+    std::condition_variable changed_;
+    std::thread reader_;
+};
+
+/* Prints the running counters and the report rate to stderr. */
+void print_progress(const SafeCounts& counts, std::chrono::steady_clock::duration elapsed) {
+    const auto seconds {std::chrono::duration<double>(elapsed).count()};
+    const auto rate {seconds > 0 ? static_cast<double>(counts.reports) / seconds : 0.0};
+    std::cerr << std::fixed << std::setprecision(1)
+              << "[" << seconds << "s] " << counts.reports << " reports ("
+              << std::setprecision(0) << rate << " reports/s), safe: " << counts.safe
+              << ", safe with removal: " << counts.safe_with_removal << "\n";
+}
+
+/* Evaluates reports read incrementally from "fd" (stdin or a FIFO).
+ * Complete lines of every block are counted as they arrive; the partial
+ * last line is carried into the next block, up to "max_line_length" bytes
+ * so memory stays bounded. A snapshot of the counters is printed every
+ * "interval", or never if it is zero.
+ * Returns false on a read error or a line over the limit.
+ */
+bool count_reports_streaming(int fd, bool use_batch,
+                             std::chrono::steady_clock::duration interval,
+                             SafeCounts& counts) {
+    constexpr size_t block_size {size_t{1} << 20};
+    // Far beyond any real report, which is a handful of small levels.
+    constexpr size_t max_line_length {size_t{64} << 10};
+    DoubleBufferedReader reader {fd, block_size};
+
+    const auto start {std::chrono::steady_clock::now()};
+    auto next_snapshot {start + interval};
+    const auto poll {interval > std::chrono::steady_clock::duration::zero()
+        ? interval : std::chrono::steady_clock::duration{std::chrono::hours{1}}};
+
+    std::string carry;
+    counts = {};
+    while (true) {
+        std::string_view block;
+        const auto status {reader.next(block, poll)};
+        if (status == DoubleBufferedReader::Status::end) {
+            break;
+        }
+
+        if (status == DoubleBufferedReader::Status::block) {
+            const auto last_newline {block.rfind('\n')};
+            if (last_newline == std::string_view::npos) {
+                carry.append(block);
+            } else {
+                // Finish the line carried over from the previous block first.
+                const auto first_newline {block.find('\n')};
+                if (!carry.empty()) {
+                    carry.append(block.substr(0, first_newline + 1));
+                    counts.merge(count_reports(carry, use_batch));
+                    carry.clear();
+                    block.remove_prefix(first_newline + 1);
+                }
+                const auto complete {block.rfind('\n') + 1};
+                counts.merge(count_reports(block.substr(0, complete), use_batch));
+                carry.assign(block.substr(complete));
+            }
+            if (carry.size() > max_line_length) {
+                std::cerr << "Line longer than " << max_line_length << " bytes.\n";
+                return false;
+            }
+        }
+
+        const auto now {std::chrono::steady_clock::now()};
+        if (interval > std::chrono::steady_clock::duration::zero() && now >= next_snapshot) {
+            print_progress(counts, now - start);
+            next_snapshot = now + interval;
+        }
+    }
+    counts.merge(count_reports(carry, use_batch));
+
+    return !reader.failed();
+}
+
+// The result lines, shared by solve() and cli_main.
+std::string result_lines(const SafeCounts& counts) {
+    return "Result Part 1 (Safe Reports): " + std::to_string(counts.safe) + "\n" +
+           "Result Part 2 (Safe Reports after with tolerance of one bad level): " +
+           std::to_string(counts.safe_with_removal) + "\n";
+}
+
+bool parse(std::string_view text, Input& input, std::string&) {
+    input.text = text;
+    return true;
+}
+
+std::string solve(Input& input, unsigned threads) {
+    return result_lines(count_reports_parallel(input.text, true, threads));
+}
+
+int cli_main(int argc, char* argv[]) {
+
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <input-file>|- [--engine=batch|row] [--threads N]"
+                     " [--stream [--progress SECONDS]] [--cache DIR [--cache-size MiB]] [--stats[=json]]"
+                     " | --self-test [reports].\n";
+        return 1;
+    }
+
+    if (std::string_view{argv[1]} == "--self-test") {
+        size_t reports {1000000};
+        if (argc > 2) {
+            const std::string_view value {argv[2]};
+            const auto [_, ec] = std::from_chars(value.data(), value.data() + value.size(), reports);
+            if (ec != std::errc()) {
+                std::cerr << "Invalid report count '" << value << "'.\n";
+                return 1;
+            }
+        }
+        const auto mismatches {run_differential_test(reports, 2024)};
+        std::cout << "Self-test: " << mismatches << " mismatches over " << reports << " reports.\n";
+        return mismatches == 0 ? 0 : 1;
+    }
+
+    auto use_batch {true};
+    aoc::ThreadOptions threads;
+    // Incremental reads for stdin ("-") and FIFOs, which can't be mapped.
+    auto streaming {std::string_view{argv[1]} == "-"};
+    std::chrono::steady_clock::duration progress_interval {};
+    aoc::stats::Recorder stats;
+    aoc::CacheOptions cache;
+    for (int i = 2; i < argc; ++i) {
+        const std::string_view arg {argv[i]};
+        if (stats.parse_flag(arg) || threads.parse_flag(argc, argv, i) || cache.parse_flag(argc, argv, i)) {
+            continue;
+        } else if (arg == "--engine=batch") {
+            use_batch = true;
+        } else if (arg == "--engine=row") {
+            use_batch = false;
+        } else if (arg == "--stream") {
+            streaming = true;
+        } else if (arg == "--progress" && i + 1 < argc) {
+            const std::string_view value {argv[++i]};
+            double seconds {0};
+            const auto [_, ec] = std::from_chars(value.data(), value.data() + value.size(), seconds);
+            if (ec != std::errc() || seconds <= 0) {
+                std::cerr << "Invalid progress interval '" << value << "'.\n";
+                return 1;
+            }
+            progress_interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(seconds));
+        } else {
+            std::cerr << "Unknown option '" << arg << "'.\n";
+            return 1;
+        }
+    }
+    if (threads.invalid || cache.invalid) {
+        return 1;
+    }
+
+    if (cache.enabled()) {
+        // The input is hashed whole, so it can't be streamed.
+        if (streaming) {
+            std::cerr << "--cache can't be combined with --stream or stdin.\n";
+            return 1;
+        }
+        return aoc::solve_cached<Input>(cache, solver_version, argv[1], parse,
+                                        [&](Input& input) { return solve(input, threads.count); }, stats);
+    }
+
+    // Reports are parsed and checked chunk by chunk, so "count" covers both.
+    SafeCounts counts;
+    if (streaming) {
+        const auto stream_phase {stats.phase("stream")};
+        const auto from_stdin {std::string_view{argv[1]} == "-"};
+        const auto fd {from_stdin ? STDIN_FILENO : ::open(argv[1], O_RDONLY)};
+        const auto ok {fd >= 0 && count_reports_streaming(fd, use_batch, progress_interval, counts)};
+        if (fd >= 0 && !from_stdin) {
+            ::close(fd);
+        }
+        if (!ok) {
+            std::cerr << "Error: could not read or parse '" << argv[1] << "'.\n";
+            return 1;
+        }
+    } else {
+        auto map_phase {stats.phase("map")};
+        const aoc::FileBuffer input {argv[1]};
+        if (!input.ok()) {
+            std::cerr << "Error: could not read or parse '" << argv[1] << "'.\n";
+            return 1;
+        }
+        map_phase.stop();
+        const auto count_phase {stats.phase("count")};
+        counts = count_reports_parallel(input.view(), use_batch, threads.count);
+    }
+
+    auto output_phase {stats.phase("output")};
+    std::cout << result_lines(counts);
+    output_phase.stop();
+
+    stats.report();
+    return 0;
+}
+
+}  // namespace day2
@@ -0,0 +1,28 @@
+/*
+ * Day 2: Red-Nosed Reports, the solver's interface (implemented in day2.cpp).
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace day2 {
+
+inline constexpr std::string_view solver_version {"day2-v1"};
+
+// The reports are parsed as they are checked, so this is the input text,
+// which must outlive it.
+struct Input {
+    std::string_view text;
+};
+
+bool parse(std::string_view text, Input& input, std::string& error);
+
+// Checks the reports in chunks on "threads" workers and returns the result
+// lines of both parts.
+std::string solve(Input& input, unsigned threads = 1);
+
+int cli_main(int argc, char* argv[]);
+
+}  // namespace day2
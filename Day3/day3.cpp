@@ -0,0 +1,592 @@
+/*
+ * Day 3: Mull It Over
+ * 
+ * Part 1: Scan the corrupted memory for uncorrupted mul instructions.
+ * An uncorrupted mul instruction is of the type mul(X, Y) where
+ * X and Y are each 1-3 digits numbers. Then, add up the result of the
+ * multiplication X * Y.
+ *  
+ * Part 2: Scan the corrupted memory for uncorrupted mul instructions, 
+ * taking into account
+ * - The do() instruction that enables future mul instructions.
+ * - The don't() instruction that disables future mul instructions.
+ * Then, add up the result of the multiplication X * Y, if mul is 
+ * enabled.
+ * 
+ * Please, refer to mull_it_over.txt to read the full assignment.
+*/
+
+
+
+#include <iostream>
+#include <cstdlib>
+#include <string_view>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <charconv>
+#include <bit>
+#include <algorithm>
+#include <vector>
+#include <string>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../Common/file_buffer.h"
+#include "../Common/result_cache.h"
+#include "../Common/stats.h"
+#include "../Common/thread_pool.h"
+#include "day3.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define DAY3_X86_DISPATCH 1
+#endif
+
+
+namespace day3 {
+
+/*
+ * Deterministic finite automaton recognizing "mul(X,Y)" (X and Y of 1-3
+ * digits), "do()" and "don't()". Every state is a prefix of one of the
+ * instructions; a byte that doesn't extend the current prefix restarts the
+ * match from the start state. That restart is exact because 'm' and 'd' only
+ * ever begin an instruction, never continue one.
+ */
+namespace dfa {
+
+enum State : uint8_t {
+    start,
+    m, mu, mul, mul_open,
+    x1, x2, x3, comma,
+    y1, y2, y3, mul_close,
+    d, do_, do_open, do_close,
+    don, don_apos, dont, dont_open, dont_close,
+    state_count
+};
+
+// What entering a state does to the scanner.
+enum Action : uint8_t { none, first_digit, next_digit_x, first_digit_y, next_digit_y,
+                        multiply, enable, disable };
+
+using Table = std::array<std::array<uint8_t, 256>, state_count>;
+
+constexpr Table make_table() {
+    Table table {};
+    // Mismatches fall back to whatever the byte means from the start state.
+    for (auto& row : table) {
+        for (auto& next : row) {
+            next = start;
+        }
+        row['m'] = m;
+        row['d'] = d;
+    }
+
+    const auto literal = [&table](State from, char ch, State to) {
+        table[from][static_cast<unsigned char>(ch)] = to;
+    };
+    const auto digits = [&table](State from, State to) {
+        for (char ch = '0'; ch <= '9'; ++ch) {
+            table[from][static_cast<unsigned char>(ch)] = to;
+        }
+    };
+
+    literal(m, 'u', mu);
+    literal(mu, 'l', mul);
+    literal(mul, '(', mul_open);
+    digits(mul_open, x1);
+    digits(x1, x2);
+    digits(x2, x3);
+    literal(x1, ',', comma);
+    literal(x2, ',', comma);
+    literal(x3, ',', comma);
+    digits(comma, y1);
+    digits(y1, y2);
+    digits(y2, y3);
+    literal(y1, ')', mul_close);
+    literal(y2, ')', mul_close);
+    literal(y3, ')', mul_close);
+
+    literal(d, 'o', do_);
+    literal(do_, '(', do_open);
+    literal(do_open, ')', do_close);
+    literal(do_, 'n', don);
+    literal(don, '\'', don_apos);
+    literal(don_apos, 't', dont);
+    literal(dont, '(', dont_open);
+    literal(dont_open, ')', dont_close);
+    return table;
+}
+
+constexpr std::array<uint8_t, state_count> make_actions() {
+    std::array<uint8_t, state_count> actions {};
+    actions[x1] = first_digit;
+    actions[x2] = next_digit_x;
+    actions[x3] = next_digit_x;
+    actions[y1] = first_digit_y;
+    actions[y2] = next_digit_y;
+    actions[y3] = next_digit_y;
+    actions[mul_close] = multiply;
+    actions[do_close] = enable;
+    actions[dont_close] = disable;
+    return actions;
+}
+
+constexpr Table transitions {make_table()};
+
+// No instruction in progress: the state just completed one or never started one.
+constexpr bool is_idle(uint8_t state) {
+    return state == start || state == mul_close || state == do_close || state == dont_close;
+}
+constexpr std::array<uint8_t, state_count> actions {make_actions()};
+
+} // namespace dfa
+
+/*
+ * Candidate search: returns the first 'm' or 'd' in [p, end), or "end".
+ * Those are the only bytes an instruction can start with.
+ */
+using CandidateFinder = const char* (*)(const char* p, const char* end);
+
+const char* find_candidate_scalar(const char* p, const char* end) {
+    while (p < end && *p != 'm' && *p != 'd') {
+        ++p;
+    }
+    return p;
+}
+
+#if defined(DAY3_X86_DISPATCH)
+__attribute__((target("sse2")))
+const char* find_candidate_sse2(const char* p, const char* end) {
+    const auto m {_mm_set1_epi8('m')};
+    const auto d {_mm_set1_epi8('d')};
+    for (; p + 16 <= end; p += 16) {
+        const auto chunk {_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))};
+        const auto hits {_mm_or_si128(_mm_cmpeq_epi8(chunk, m), _mm_cmpeq_epi8(chunk, d))};
+        const auto mask {static_cast<unsigned>(_mm_movemask_epi8(hits))};
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+    }
+    return find_candidate_scalar(p, end);
+}
+
+__attribute__((target("avx2")))
+const char* find_candidate_avx2(const char* p, const char* end) {
+    const auto m {_mm256_set1_epi8('m')};
+    const auto d {_mm256_set1_epi8('d')};
+    for (; p + 32 <= end; p += 32) {
+        const auto chunk {_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p))};
+        const auto hits {_mm256_or_si256(_mm256_cmpeq_epi8(chunk, m), _mm256_cmpeq_epi8(chunk, d))};
+        const auto mask {static_cast<unsigned>(_mm256_movemask_epi8(hits))};
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+    }
+    return find_candidate_sse2(p, end);
+}
+#endif
+
+// Picks the widest search the running CPU supports.
+CandidateFinder select_candidate_finder() {
+#if defined(DAY3_X86_DISPATCH)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return find_candidate_avx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return find_candidate_sse2;
+    }
+#endif
+    return find_candidate_scalar;
+}
+
+/*
+ * Checks the 4 bytes at "p" against "mul(", "do()" and "don'" with one
+ * packed 32-bit compare each. Callers ensure 4 bytes are readable.
+ */
+bool has_instruction_prefix(const char* p) {
+    constexpr auto pack = [](const char (&word)[5]) {
+        uint32_t packed {0};
+        for (int i = 3; i >= 0; --i) {
+            packed = (packed << 8) | static_cast<unsigned char>(word[i]);
+        }
+        return packed;
+    };
+    // Byte order of the packed words matches a little-endian load.
+    constexpr auto mul_open {pack("mul(")};
+    constexpr auto do_close {pack("do()")};
+    constexpr auto don_apos {pack("don'")};
+
+    uint32_t word;
+    std::memcpy(&word, p, sizeof(word));
+    if constexpr (std::endian::native == std::endian::big) {
+        word = __builtin_bswap32(word);
+    }
+    return word == mul_open || word == do_close || word == don_apos;
+}
+
+/*
+ * Resumable instruction scanner: feeding a text in several pieces gives the
+ * same sums as feeding it at once, since the automaton state and the
+ * operands read so far carry over between calls.
+ */
+struct InstructionScanner {
+    uint8_t state {dfa::start};
+    int64_t x {0};
+    int64_t y {0};
+    // mul instructions start enabled.
+    bool enabled {true};
+    int64_t sum_mul {0};
+    int64_t sum_mul_if_enabled {0};
+    // Whether a do()/don't() was seen, and the muls preceding the first one.
+    // They tell what sum_mul_if_enabled would have been had the scan
+    // started disabled.
+    bool toggled {false};
+    int64_t sum_mul_before_toggle {0};
+
+    // Bytes the prefilter ruled out without running the automaton, out of "scanned".
+    uint64_t skipped {0};
+    uint64_t scanned {0};
+
+    // Runs the automaton over "text", touching each byte once.
+    void scan(std::string_view text) {
+        for (const auto ch : text) {
+            step(static_cast<unsigned char>(ch));
+        }
+        scanned += text.size();
+    }
+
+    /*
+     * Same result as scan(), but while no instruction is in progress the
+     * text is searched for the next 'm' or 'd' with SIMD, and a candidate
+     * only reaches the automaton if it starts with an instruction prefix.
+     */
+    void scan_prefiltered(std::string_view text) {
+        static const auto find_candidate {select_candidate_finder()};
+        const char* p {text.data()};
+        const char* const end {p + text.size()};
+        while (p < end) {
+            if (dfa::is_idle(state)) {
+                const auto* candidate {find_candidate(p, end)};
+                skipped += static_cast<uint64_t>(candidate - p);
+                p = candidate;
+                if (p == end) {
+                    break;
+                }
+                // Too close to the end to tell: let the automaton decide.
+                if (end - p >= 4 && !has_instruction_prefix(p)) {
+                    ++skipped;
+                    ++p;
+                    continue;
+                }
+            }
+            step(static_cast<unsigned char>(*p));
+            ++p;
+        }
+        scanned += text.size();
+    }
+
+    double skip_rate() const {
+        return scanned == 0 ? 0.0 : static_cast<double>(skipped) / static_cast<double>(scanned);
+    }
+
+    /*
+     * Completes an instruction still in progress at the end of the last
+     * scan, reading only as far into "text" as it needs. Stops before any
+     * 'm' or 'd': those begin an instruction, never continue one.
+     */
+    void finish(std::string_view text) {
+        for (const auto ch : text) {
+            if (dfa::is_idle(state) || ch == 'm' || ch == 'd') {
+                break;
+            }
+            step(static_cast<unsigned char>(ch));
+        }
+    }
+
+private:
+    void step(unsigned char byte) {
+        state = dfa::transitions[state][byte];
+        switch (dfa::actions[state]) {
+            case dfa::none:
+                break;
+            case dfa::first_digit:
+                x = byte - '0';
+                break;
+            case dfa::next_digit_x:
+                x = x * 10 + (byte - '0');
+                break;
+            case dfa::first_digit_y:
+                y = byte - '0';
+                break;
+            case dfa::next_digit_y:
+                y = y * 10 + (byte - '0');
+                break;
+            case dfa::multiply:
+                sum_mul += x * y;
+                if (enabled) {
+                    sum_mul_if_enabled += x * y;
+                }
+                if (!toggled) {
+                    sum_mul_before_toggle += x * y;
+                }
+                break;
+            case dfa::enable:
+                enabled = true;
+                toggled = true;
+                break;
+            case dfa::disable:
+                enabled = false;
+                toggled = true;
+                break;
+        }
+    }
+};
+
+/*
+ * What a segment contributes, for either enable state at its start.
+ * Segments are independent; the state only flows between them through
+ * "toggled"/"final_enabled".
+ */
+struct SegmentSummary {
+    int64_t sum_mul {0};
+    int64_t sum_if_start_enabled {0};
+    int64_t sum_if_start_disabled {0};
+    bool toggled {false};
+    bool final_enabled {true};
+    uint64_t skipped {0};
+    uint64_t scanned {0};
+
+    double skip_rate() const {
+        return scanned == 0 ? 0.0 : static_cast<double>(skipped) / static_cast<double>(scanned);
+    }
+};
+
+/*
+ * Scans the instructions starting in text[begin, end). An instruction
+ * straddling "end" is completed by reading past it, and the one straddling
+ * "begin" belongs to the previous segment: starting from the automaton's
+ * start state, its tail can't match anything since it holds no 'm' or 'd'.
+ */
+SegmentSummary scan_segment(std::string_view text, size_t begin, size_t end, bool use_prefilter) {
+    InstructionScanner scanner;
+    const auto segment {text.substr(begin, end - begin)};
+    if (use_prefilter) {
+        scanner.scan_prefiltered(segment);
+    } else {
+        scanner.scan(segment);
+    }
+    scanner.finish(text.substr(end));
+
+    SegmentSummary summary;
+    summary.sum_mul = scanner.sum_mul;
+    summary.sum_if_start_enabled = scanner.sum_mul_if_enabled;
+    summary.sum_if_start_disabled = scanner.sum_mul_if_enabled - scanner.sum_mul_before_toggle;
+    summary.toggled = scanner.toggled;
+    summary.final_enabled = scanner.enabled;
+    summary.skipped = scanner.skipped;
+    summary.scanned = scanner.scanned;
+    return summary;
+}
+
+/*
+ * Scans "text" as one segment per thread on a work-stealing pool (segments
+ * below "min_segment" bytes aren't worth a thread), then composes the
+ * segments left to right: each one contributes the sum matching the enable
+ * state left by the previous ones. The result equals a serial scan.
+ */
+SegmentSummary scan_parallel(std::string_view text, bool use_prefilter, unsigned threads,
+                             size_t min_segment = size_t{1} << 20) {
+    const auto segments {std::clamp<size_t>(text.size() / min_segment, 1, std::max(threads, 1u))};
+    const auto segment_size {(text.size() + segments - 1) / segments};
+
+    std::vector<SegmentSummary> summaries(segments);
+    const auto scan = [&](size_t s) {
+        const auto begin {std::min(text.size(), s * segment_size)};
+        const auto end {std::min(text.size(), begin + segment_size)};
+        summaries[s] = scan_segment(text, begin, end, use_prefilter);
+    };
+    if (segments == 1) {
+        scan(0);
+    } else {
+        aoc::WorkStealingPool pool {static_cast<unsigned>(segments)};
+        for (size_t s = 0; s < segments; ++s) {
+            pool.submit([&scan, s] { scan(s); });
+        }
+        pool.wait();
+    }
+
+    // mul instructions start enabled.
+    SegmentSummary total;
+    auto enabled {true};
+    for (const auto& summary : summaries) {
+        total.sum_mul += summary.sum_mul;
+        total.sum_if_start_enabled += enabled ? summary.sum_if_start_enabled
+                                              : summary.sum_if_start_disabled;
+        if (summary.toggled) {
+            enabled = summary.final_enabled;
+        }
+        total.skipped += summary.skipped;
+        total.scanned += summary.scanned;
+    }
+    total.toggled = std::any_of(summaries.begin(), summaries.end(),
+        [](const SegmentSummary& summary) { return summary.toggled; });
+    total.final_enabled = enabled;
+    return total;
+}
+
+/*
+ * Scans "fd" incrementally through a fixed-size buffer, so memory stays
+ * constant on unbounded inputs such as live pipes. Nothing needs to be
+ * kept from one refill to the next: an instruction cut by a refill is
+ * carried by the automaton state and the operands read so far.
+ * Returns false on a read error.
+ */
+bool scan_stream(int fd, bool use_prefilter, InstructionScanner& scanner) {
+    constexpr size_t buffer_size {size_t{64} << 10};
+    std::array<char, buffer_size> buffer;
+    while (true) {
+        const auto got {::read(fd, buffer.data(), buffer.size())};
+        if (got < 0) {
+            return false;
+        }
+        if (got == 0) {
+            return true;
+        }
+        const std::string_view block {buffer.data(), static_cast<size_t>(got)};
+        if (use_prefilter) {
+            scanner.scan_prefiltered(block);
+        } else {
+            scanner.scan(block);
+        }
+    }
+}
+
+// The result lines, shared by solve() and every print path of cli_main.
+std::string result_lines(int64_t sum_mul, int64_t sum_mul_if_enabled) {
+    return "Result Part 1 (Uncorrupted muls summation): " + std::to_string(sum_mul) + "\n" +
+           "Result Part 2 (Uncorrupted and enabled muls summation): " +
+           std::to_string(sum_mul_if_enabled) + "\n";
+}
+
+bool parse(std::string_view text, Input& input, std::string& error) {
+    if (text.empty()) {
+        error = "Instructions is empty.";
+        return false;
+    }
+    input.text = text;
+    return true;
+}
+
+std::string solve(Input& input, unsigned threads) {
+    const auto result {scan_parallel(input.text, true, threads)};
+    return result_lines(result.sum_mul, result.sum_if_start_enabled);
+}
+
+int cli_main(int argc, char* argv[]) {
+    
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <input-file>|- [--scanner=prefilter|dfa] [--threads N]"
+                     " [--stream] [--verbose] [--cache DIR [--cache-size MiB]] [--stats[=json]].\n";
+        return 1;
+    }
+
+    // The plain automaton is kept as the reference for the prefilter.
+    auto use_prefilter {true};
+    // Report the prefilter skip rate on stderr.
+    auto verbose {false};
+    aoc::ThreadOptions threads;
+    // Constant-memory scan for stdin ("-") and live pipes.
+    auto streaming {std::string_view{argv[1]} == "-"};
+    aoc::stats::Recorder stats;
+    aoc::CacheOptions cache;
+    for (int i = 2; i < argc; ++i) {
+        const std::string_view arg {argv[i]};
+        if (stats.parse_flag(arg) || threads.parse_flag(argc, argv, i) || cache.parse_flag(argc, argv, i)) {
+            continue;
+        } else if (arg == "--scanner=prefilter") {
+            use_prefilter = true;
+        } else if (arg == "--scanner=dfa") {
+            use_prefilter = false;
+        } else if (arg == "--verbose") {
+            verbose = true;
+        } else if (arg == "--stream") {
+            streaming = true;
+        } else {
+            std::cerr << "Unknown option '" << arg << "'.\n";
+            return 1;
+        }
+    }
+    if (threads.invalid || cache.invalid) {
+        return 1;
+    }
+
+    if (cache.enabled()) {
+        // The input is hashed whole, so it can't be streamed.
+        if (streaming) {
+            std::cerr << "--cache can't be combined with --stream or stdin.\n";
+            return 1;
+        }
+        return aoc::solve_cached<Input>(cache, solver_version, argv[1], parse,
+                                        [&](Input& input) { return solve(input, threads.count); }, stats);
+    }
+
+    if (streaming) {
+        const auto from_stdin {std::string_view{argv[1]} == "-"};
+        const auto fd {from_stdin ? STDIN_FILENO : ::open(argv[1], O_RDONLY)};
+        InstructionScanner scanner;
+        auto stream_phase {stats.phase("stream")};
+        const auto ok {fd >= 0 && scan_stream(fd, use_prefilter, scanner)};
+        stream_phase.stop();
+        if (fd >= 0 && !from_stdin) {
+            ::close(fd);
+        }
+        if (!ok) {
+            std::cerr << "Error: could not read or parse '" << argv[1] << "'.\n";
+            return 1;
+        }
+        if (scanner.scanned == 0) {
+            std::cerr << "Instructions is empty.\n";
+            return 1;
+        }
+        if (verbose && use_prefilter) {
+            std::cerr << "Prefilter skip rate: " << 100.0 * scanner.skip_rate() << "%\n";
+        }
+        auto output_phase {stats.phase("output")};
+        std::cout << result_lines(scanner.sum_mul, scanner.sum_mul_if_enabled);
+        output_phase.stop();
+        stats.report();
+        return 0;
+    }
+
+    auto load_phase {stats.phase("load")};
+    const aoc::FileBuffer input {argv[1]};
+    if (!input.ok()) {
+        std::cerr << "Error: could not read or parse '" << argv[1] << "'.\n";
+        return 1;
+    }
+    const auto instructions {input.view()};
+    if (instructions.empty()) {
+      std::cerr << "Instructions is empty.\n";
+      return 1;  
+    }
+    load_phase.stop();
+   
+    // Part 1 - 2
+    auto scan_phase {stats.phase("scan")};
+    const auto result {scan_parallel(instructions, use_prefilter, threads.count)};
+    scan_phase.stop();
+    if (verbose && use_prefilter) {
+        std::cerr << "Prefilter skip rate: " << 100.0 * result.skip_rate() << "%\n";
+    }
+    auto output_phase {stats.phase("output")};
+    std::cout << result_lines(result.sum_mul, result.sum_if_start_enabled);
+    output_phase.stop();
+
+    stats.report();
+    return 0;
+}
+
+}  // namespace day3
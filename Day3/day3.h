@@ -0,0 +1,27 @@
+/*
+ * Day 3: Mull It Over, the solver's interface (implemented in day3.cpp).
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace day3 {
+
+inline constexpr std::string_view solver_version {"day3-v1"};
+
+// The corrupted memory, scanned in place; the text must outlive it.
+struct Input {
+    std::string_view text;
+};
+
+// Fails on an empty memory.
+bool parse(std::string_view text, Input& input, std::string& error);
+
+// Scans the memory in "threads" segments and returns the result lines.
+std::string solve(Input& input, unsigned threads = 1);
+
+int cli_main(int argc, char* argv[]);
+
+}  // namespace day3
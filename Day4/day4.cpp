@@ -0,0 +1,836 @@
+/*
+Day 4: Ceres Search
+
+ * Part 1: Count all occurrences of "XMAS" in any of 8 directions.
+ * Part 2: Count all "X-MAS" shapes (two "MAS" diagonals crossing at 'A').
+ * 
+ * Please, refer to ceres_search.txt to read the full assignment.
+*/
+
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <string_view>
+#include <ranges>
+#include <array>
+#include <cstdint>
+#include <bit>
+#include <algorithm>
+#include <utility>
+#include <atomic>
+#include <thread>
+#include <charconv>
+#include <random>
+
+#include "../Common/file_buffer.h"
+#include "../Common/result_cache.h"
+#include "../Common/stats.h"
+#include "../Common/thread_pool.h"
+#include "day4.h"
+
+
+namespace day4 {
+
+// Directions
+const std::vector<std::pair<int,int>> all_dirs = {
+    {-1,  0 }, { 1,  0 },  // North (N), South (S)
+    { 0, -1 }, { 0,  1 },  // West (W), East (E)
+    {-1, -1 }, {-1,  1 },  // North West (NW), North East (NE)
+    { 1, -1 }, { 1,  1 }   // South West (SW), South East (SE)
+};
+
+/*
+ * Splits rows [0, rows) into horizontal bands of "band_rows" rows and calls
+ * work(r_begin, r_end) for each on a work-stealing pool of "threads"
+ * workers, or on the calling thread for one thread or one band. Work on a
+ * band may read the rows just past it (its halo), since the grid is shared
+ * read-only; it must only write its own rows.
+ */
+template <typename Work>
+void for_each_band(int rows, int band_rows, unsigned threads, Work&& work) {
+    band_rows = std::max(band_rows, 1);
+    const auto bands {(rows + band_rows - 1) / band_rows};
+    const auto run = [&](int band) {
+        const auto r_begin {band * band_rows};
+        work(r_begin, std::min(rows, r_begin + band_rows));
+    };
+    if (threads <= 1 || bands <= 1) {
+        for (int band = 0; band < bands; ++band) {
+            run(band);
+        }
+        return;
+    }
+
+    aoc::WorkStealingPool pool {std::min(threads, static_cast<unsigned>(bands))};
+    for (int band = 0; band < bands; ++band) {
+        pool.submit([&run, band] { run(band); });
+    }
+    pool.wait();
+}
+
+/*
+ * Sums count(r_begin, r_end) over the bands of for_each_band. Each call
+ * counts only the matches anchored in its own rows, reading up to the word
+ * length - 1 rows beyond, so no match is counted twice whatever the band size.
+ */
+template <typename Count>
+int count_in_bands(int rows, int band_rows, unsigned threads, Count&& count) {
+    std::atomic<int> total {0};
+    for_each_band(rows, band_rows, threads, [&](int r_begin, int r_end) {
+        total += count(r_begin, r_end);
+    });
+    return total;
+}
+
+/*
+ * A match reported by WordSearch: "word" (an index into its word list) starts
+ * at (row, col) and reads along (r_dir, c_dir).
+ */
+struct WordMatch {
+    int word;
+    int row, col;
+    int r_dir, c_dir;
+};
+
+/*
+ * Multi-word search over the 8 directions (Aho-Corasick). All words and their
+ * reversals go into one automaton, which walks each line of the 4 line
+ * families (rows, columns, diagonals, anti-diagonals) once in its forward
+ * sense: a reversed word found on a line is the word read the other way.
+ */
+class WordSearch {
+public:
+    // Only the directions in "dirs" are searched.
+    WordSearch(const std::vector<std::string_view>& words,
+               const std::vector<std::pair<int,int>>& dirs)
+        : words_ {words.size()} {
+        for (const auto& word : words) {
+            for (const auto letter : word) {
+                auto& symbol {symbol_of_[static_cast<unsigned char>(letter)]};
+                if (symbol == 0) {
+                    symbol = ++symbols_;
+                }
+            }
+            max_length_ = std::max(max_length_, static_cast<int>(word.size()));
+        }
+        ++symbols_;  // symbol 0 stands for every letter in no word
+
+        for (const auto& [r_dir, c_dir] : dirs) {
+            for (int family = 0; family < families; ++family) {
+                const auto [line_r, line_c] {steps[family]};
+                if (r_dir == line_r && c_dir == line_c) {
+                    enabled_[family][0] = true;
+                } else if (r_dir == -line_r && c_dir == -line_c) {
+                    enabled_[family][1] = true;
+                }
+            }
+        }
+
+        build(words);
+    }
+
+    /*
+     * Per-word counts of the matches whose topmost row lies in [r_begin, r_end),
+     * appending them to "matches" when given. Lines are read up to the longest
+     * word length - 1 rows past r_end, so bands sum to the whole-grid count.
+     */
+    std::vector<int> count(const Grid& grid, int r_begin, int r_end,
+                           std::vector<WordMatch>* matches = nullptr) const {
+        std::vector<int> counts(words_, 0);
+        const auto r_scan_end {std::min(grid.rows(), r_end + max_length_ - 1)};
+        for (int family = 0; family < families; ++family) {
+            if (!enabled_[family][0] && !enabled_[family][1]) {
+                continue;
+            }
+            const auto [r_dir, c_dir] {steps[family]};
+            // Each line starts on row r_begin or, for diagonals, on the side it enters from.
+            const auto scan = [&](int r, int c) {
+                scan_line(grid, r, c, r_dir, c_dir, r_dir == 0 ? r + 1 : r_scan_end, r_end, family, counts, matches);
+            };
+            if (r_dir == 0) {
+                for (int r = r_begin; r < r_end; ++r) {
+                    scan(r, 0);
+                }
+                continue;
+            }
+            for (int c = 0; c < grid.cols(); ++c) {
+                scan(r_begin, c);
+            }
+            if (c_dir != 0) {
+                for (int r = r_begin + 1; r < r_scan_end; ++r) {
+                    scan(r, c_dir > 0 ? 0 : grid.cols() - 1);
+                }
+            }
+        }
+        return counts;
+    }
+
+private:
+    static constexpr int families {4};
+    // Forward step of each line family: E, S, SE, SW.
+    static constexpr std::array<std::pair<int,int>, families> steps {{{0, 1}, {1, 0}, {1, 1}, {1, -1}}};
+
+    struct Output {
+        int word;
+        int length;
+        bool reversed;
+    };
+
+    // Trie of the words and their reversals, then failure links folded into
+    // a dense transition table, breadth first.
+    void build(const std::vector<std::string_view>& words) {
+        std::vector<std::vector<Output>> outputs(1);
+        next_.assign(symbols_, -1);
+        for (size_t w = 0; w < words.size(); ++w) {
+            if (words[w].empty()) {
+                continue;
+            }
+            for (const auto reversed : {false, true}) {
+                int state {0};
+                for (size_t k = 0; k < words[w].size(); ++k) {
+                    const auto letter {reversed ? words[w][words[w].size() - 1 - k] : words[w][k]};
+                    auto& target {next_[size_t(state) * symbols_ + symbol_of_[static_cast<unsigned char>(letter)]]};
+                    if (target < 0) {
+                        target = static_cast<int>(outputs.size());
+                        outputs.emplace_back();
+                        next_.resize(next_.size() + symbols_, -1);
+                    }
+                    state = next_[size_t(state) * symbols_ + symbol_of_[static_cast<unsigned char>(letter)]];
+                }
+                outputs[state].push_back({static_cast<int>(w), static_cast<int>(words[w].size()), reversed});
+            }
+        }
+
+        const auto states {outputs.size()};
+        std::vector<int> fail(states, 0);
+        std::vector<int> queue;
+        queue.reserve(states);
+        for (int symbol = 0; symbol < symbols_; ++symbol) {
+            auto& target {next_[symbol]};
+            if (target < 0) {
+                target = 0;
+            } else {
+                queue.push_back(target);
+            }
+        }
+        for (size_t head = 0; head < queue.size(); ++head) {
+            const auto state {queue[head]};
+            const auto& suffix {outputs[fail[state]]};
+            outputs[state].insert(outputs[state].end(), suffix.begin(), suffix.end());
+            for (int symbol = 0; symbol < symbols_; ++symbol) {
+                auto& target {next_[size_t(state) * symbols_ + symbol]};
+                const auto fallback {next_[size_t(fail[state]) * symbols_ + symbol]};
+                if (target < 0) {
+                    target = fallback;
+                } else {
+                    fail[target] = fallback;
+                    queue.push_back(target);
+                }
+            }
+        }
+
+        first_output_.assign(states + 1, 0);
+        for (size_t state = 0; state < states; ++state) {
+            first_output_[state + 1] = first_output_[state] + static_cast<int>(outputs[state].size());
+            outputs_.insert(outputs_.end(), outputs[state].begin(), outputs[state].end());
+        }
+    }
+
+    // Walk one line from (r, c) to the grid edge or row "r_limit", keeping
+    // the matches whose topmost row is before "r_end".
+    void scan_line(const Grid& grid, int r, int c, int r_dir, int c_dir,
+                   int r_limit, int r_end, int family,
+                   std::vector<int>& counts, std::vector<WordMatch>* matches) const {
+        int state {0};
+        for (; r < r_limit && c >= 0 && c < grid.cols(); r += r_dir, c += c_dir) {
+            state = next_[size_t(state) * symbols_ + symbol_of_[static_cast<unsigned char>(grid(r, c))]];
+            for (auto o {first_output_[state]}; o < first_output_[state + 1]; ++o) {
+                const auto& output {outputs_[o]};
+                const auto back {output.length - 1};
+                // Lines other than rows may run into the halo below the band.
+                if (!enabled_[family][output.reversed] || r - r_dir * back >= r_end) {
+                    continue;
+                }
+                ++counts[output.word];
+                if (matches) {
+                    if (output.reversed) {
+                        matches->push_back({output.word, r, c, -r_dir, -c_dir});
+                    } else {
+                        matches->push_back({output.word, r - r_dir * back, c - c_dir * back, r_dir, c_dir});
+                    }
+                }
+            }
+        }
+    }
+
+    size_t words_;
+    int symbols_ {0};
+    int max_length_ {0};
+    std::array<int, 256> symbol_of_ {};
+    std::array<std::array<bool, 2>, families> enabled_ {};
+    std::vector<int> next_;
+    std::vector<int> first_output_;
+    std::vector<Output> outputs_;
+};
+
+// Generic word-count in any of 8 dirs, for the words whose topmost row is in
+// [r_begin, r_end): the single-word case of WordSearch.
+int count_occurrences(const Grid& grid,
+                     std::string_view word,
+                     const std::vector<std::pair<int,int>>& dirs,
+                     int r_begin, int r_end) {
+    const WordSearch search {{word}, dirs};
+    return search.count(grid, r_begin, r_end)[0];
+}
+
+/*
+ * An N x N pattern of letters, where '.' matches any cell. Stencils are
+ * built at compile time and passed as template arguments, so matching one
+ * compiles to straight-line code. Any size works, e.g. 3x3 or 5x5.
+ */
+template <int N>
+struct Stencil {
+    static constexpr int size {N};
+    std::array<std::array<char, N>, N> cells {};
+
+    // The stencil turned a quarter clockwise.
+    constexpr Stencil rotated() const {
+        Stencil result;
+        for (int r = 0; r < N; ++r) {
+            for (int c = 0; c < N; ++c) {
+                result.cells[c][N - 1 - r] = cells[r][c];
+            }
+        }
+        return result;
+    }
+
+    constexpr bool operator==(const Stencil&) const = default;
+};
+
+/*
+ * "word" on both diagonals of an N x N square, crossing in the middle, e.g.
+ * for "MAS":
+ *
+ *  M.S
+ *  .A.
+ *  M.S
+ *
+ * Its rotations cover every way of reading the two diagonals.
+ */
+template <int N>
+constexpr Stencil<N> make_x_stencil(std::string_view word) {
+    Stencil<N> stencil;
+    for (auto& row : stencil.cells) {
+        row.fill('.');
+    }
+    for (int k = 0; k < N; ++k) {
+        stencil.cells[k][k] = word[k];
+        stencil.cells[N - 1 - k][k] = word[k];
+    }
+    return stencil;
+}
+
+// The distinct quarter turns of a stencil; a symmetric one has fewer than 4.
+template <int N>
+struct Rotations {
+    std::array<Stencil<N>, 4> stencils {};
+    int count {0};
+};
+
+template <int N>
+constexpr Rotations<N> distinct_rotations(const Stencil<N>& stencil) {
+    Rotations<N> rotations;
+    auto turned {stencil};
+    for (int turn = 0; turn < 4; ++turn) {
+        const auto end {rotations.stencils.begin() + rotations.count};
+        if (std::find(rotations.stencils.begin(), end, turned) == end) {
+            rotations.stencils[rotations.count++] = turned;
+        }
+        turned = turned.rotated();
+    }
+    return rotations;
+}
+
+/* Whether "stencil" matches with its top-left corner on "cell". The '.'
+ * cells drop out at compile time and the rest are ANDed without branches.
+ */
+template <auto stencil>
+bool stencil_matches(const char* cell, std::ptrdiff_t stride) {
+    constexpr auto n {stencil.size};
+    return [&]<size_t... I>(std::index_sequence<I...>) {
+        return ((stencil.cells[I / n][I % n] == '.' ||
+                 cell[std::ptrdiff_t(I / n) * stride + I % n] == stencil.cells[I / n][I % n]) & ...);
+    }(std::make_index_sequence<size_t(n) * n>{});
+}
+
+/*
+ * Count the placements of "stencil", in any of its distinct rotations, lying
+ * inside the grid with their top row in [r_begin, r_end).
+ */
+template <auto stencil>
+int count_stencil(const Grid& grid, int r_begin, int r_end) {
+    constexpr auto n {stencil.size};
+    static constexpr auto rotations {distinct_rotations(stencil)};
+    int count {0};
+    for (int r = r_begin; r < std::min(r_end, grid.rows() - n + 1); ++r) {
+        const char* row {grid.row(r)};
+        for (int c = 0; c + n <= grid.cols(); ++c) {
+            count += [&]<size_t... I>(std::index_sequence<I...>) {
+                return (int {stencil_matches<rotations.stencils[I]>(row + c, grid.stride())} + ...);
+            }(std::make_index_sequence<rotations.count>{});
+        }
+    }
+    return count;
+}
+
+/*
+ * The grid reduced to one bitmask ("plane") per letter of interest:
+ * bit c of row r in the plane of a letter is set when grid[r][c] holds it.
+ * Rows are padded to whole 64-bit words with zero bits.
+ */
+class LetterPlanes {
+public:
+    // Rows are filled band by band on "threads" threads.
+    LetterPlanes(const Grid& grid, std::string_view letters, unsigned threads = 1)
+        : rows_ {grid.rows()}, cols_ {grid.cols()},
+          words_per_row_ {(cols_ + 63) / 64} {
+        plane_of_.fill(-1);
+        for (const auto letter : letters) {
+            auto& plane {plane_of_[static_cast<unsigned char>(letter)]};
+            if (plane < 0) {
+                plane = planes_++;
+            }
+        }
+
+        bits_.assign(size_t(planes_) * rows_ * words_per_row_, 0);
+        constexpr int band_rows {256};
+        for_each_band(rows_, band_rows, threads, [&](int r_begin, int r_end) {
+            for (int r = r_begin; r < r_end; ++r) {
+                const char* line {grid.row(r)};
+                for (int c = 0; c < cols_; ++c) {
+                    const auto plane {plane_of_[static_cast<unsigned char>(line[c])]};
+                    if (plane >= 0) {
+                        word(plane, r, c / 64) |= uint64_t{1} << (c % 64);
+                    }
+                }
+            }
+        });
+    }
+
+    int rows() const { return rows_; }
+    int cols() const { return cols_; }
+    int words_per_row() const { return words_per_row_; }
+
+    /* Word "w" of row "r" of the plane of "letter", shifted so that bit c
+     * holds column c + shift. Columns outside the grid read as 0.
+     */
+    uint64_t shifted(char letter, int r, int w, int shift) const {
+        const auto plane {plane_of_[static_cast<unsigned char>(letter)]};
+        const auto first {w * 64 + shift};
+        const auto word_index {first >= 0 ? first / 64 : (first - 63) / 64};
+        const auto offset {first - word_index * 64};
+
+        const auto low {fetch(plane, r, word_index)};
+        if (offset == 0) {
+            return low;
+        }
+        const auto high {fetch(plane, r, word_index + 1)};
+        return (low >> offset) | (high << (64 - offset));
+    }
+
+private:
+    uint64_t& word(int plane, int r, int w) {
+        return bits_[(size_t(plane) * rows_ + r) * words_per_row_ + w];
+    }
+
+    uint64_t fetch(int plane, int r, int w) const {
+        if (plane < 0 || w < 0 || w >= words_per_row_) {
+            return 0;
+        }
+        return bits_[(size_t(plane) * rows_ + r) * words_per_row_ + w];
+    }
+
+    int rows_;
+    int cols_;
+    int words_per_row_;
+    int planes_ {0};
+    std::array<int, 256> plane_of_ {};
+    std::vector<uint64_t> bits_;
+};
+
+/* Same count as count_occurrences, 64 start cells at a time: for a
+ * direction, the starts matching "word" are the AND of the letter planes of
+ * word[k], each taken k steps away, and popcount tallies them.
+ * Only starts in rows [r_begin, r_end) are counted.
+ */
+int count_occurrences_bitplanes(const LetterPlanes& planes,
+                                std::string_view word,
+                                const std::vector<std::pair<int,int>>& dirs,
+                                int r_begin, int r_end) {
+    const int len {int(word.size())};
+    int count {0};
+    for (auto [r_dir, c_dir]: dirs) {
+        // Only start rows whose last letter still lies inside the grid.
+        const auto r_first {std::max(r_begin, -r_dir * (len - 1))};
+        const auto r_last {std::min(r_end, planes.rows() - r_dir * (len - 1))};
+        for (int r = r_first; r < r_last; ++r) {
+            for (int w = 0; w < planes.words_per_row(); ++w) {
+                auto starts {~uint64_t{0}};
+                for (int k = 0; k < len && starts != 0; ++k) {
+                    starts &= planes.shifted(word[k], r + k * r_dir, w, k * c_dir);
+                }
+                count += std::popcount(starts);
+            }
+        }
+    }
+    return count;
+}
+
+/* Placements of "stencil" with their top-left corner in word "w" of row "r",
+ * as a bitmask: the AND of the planes of its letters, each shifted by its
+ * offset. "planes" must hold every letter of the stencil.
+ */
+template <auto stencil>
+uint64_t stencil_matches_bitplanes(const LetterPlanes& planes, int r, int w) {
+    constexpr auto n {stencil.size};
+    return [&]<size_t... I>(std::index_sequence<I...>) {
+        return ((stencil.cells[I / n][I % n] == '.'
+                     ? ~uint64_t{0}
+                     : planes.shifted(stencil.cells[I / n][I % n], r + int(I / n), w, int(I % n))) & ...);
+    }(std::make_index_sequence<size_t(n) * n>{});
+}
+
+// Same count as count_stencil, 64 placements at a time.
+template <auto stencil>
+int count_stencil_bitplanes(const LetterPlanes& planes, int r_begin, int r_end) {
+    constexpr auto n {stencil.size};
+    static constexpr auto rotations {distinct_rotations(stencil)};
+    // Placements must also fit to the right of their corner.
+    const auto c_end {planes.cols() - n + 1};
+    int count {0};
+    for (int r = r_begin; r < std::min(r_end, planes.rows() - n + 1); ++r) {
+        for (int w = 0; w < planes.words_per_row() && w * 64 < c_end; ++w) {
+            const auto fits {c_end - w * 64 >= 64 ? ~uint64_t{0} : (uint64_t{1} << (c_end - w * 64)) - 1};
+            const auto matches {[&]<size_t... I>(std::index_sequence<I...>) {
+                return (std::popcount(stencil_matches_bitplanes<rotations.stencils[I]>(planes, r, w) & fits) + ...);
+            }(std::make_index_sequence<rotations.count>{})};
+            count += matches;
+        }
+    }
+    return count;
+}
+
+/*
+ * An N x N stencil from its rows, top to bottom, e.g. "M.S" ".A." "M.S".
+ */
+template <int N>
+constexpr Stencil<N> make_stencil(std::string_view cells) {
+    Stencil<N> stencil;
+    for (int k = 0; k < N * N; ++k) {
+        stencil.cells[k / N][k % N] = cells[k];
+    }
+    return stencil;
+}
+
+/* Reference count for the stencil kernels: every placement inside the grid,
+ * against every distinct quarter turn built at run time, cell by cell.
+ */
+template <int N>
+int count_stencil_brute_force(const Grid& grid, const Stencil<N>& stencil) {
+    std::vector<Stencil<N>> turns;
+    auto turned {stencil};
+    for (int turn = 0; turn < 4; ++turn) {
+        if (std::find(turns.begin(), turns.end(), turned) == turns.end()) {
+            turns.push_back(turned);
+        }
+        turned = turned.rotated();
+    }
+    int count {0};
+    for (int r = 0; r + N <= grid.rows(); ++r) {
+        for (int c = 0; c + N <= grid.cols(); ++c) {
+            for (const auto& turn : turns) {
+                auto match {true};
+                for (int i = 0; i < N * N && match; ++i) {
+                    const auto letter {turn.cells[i / N][i % N]};
+                    match = letter == '.' || grid(r + i / N, c + i % N) == letter;
+                }
+                count += match;
+            }
+        }
+    }
+    return count;
+}
+
+/* Compares count_stencil and count_stencil_bitplanes (whole grid, and in
+ * 3-row bands on 2 threads, which reads across band halos) with the brute
+ * force count. Disagreements are described on stderr if "report" is set.
+ * Returns their number.
+ */
+template <auto stencil>
+size_t check_stencil(const Grid& grid, bool report) {
+    const LetterPlanes planes {grid, "XMAS"};
+    const auto expected {count_stencil_brute_force(grid, stencil)};
+    const int counts[] {
+        count_stencil<stencil>(grid, 0, grid.rows()),
+        count_stencil_bitplanes<stencil>(planes, 0, grid.rows()),
+        count_in_bands(grid.rows(), 3, 2, [&](int r_begin, int r_end) {
+            return count_stencil_bitplanes<stencil>(planes, r_begin, r_end);
+        }),
+    };
+    size_t mismatches {0};
+    for (const auto count : counts) {
+        mismatches += count != expected;
+    }
+    if (mismatches != 0 && report) {
+        std::cerr << "Mismatch on a " << grid.rows() << "x" << grid.cols() << " grid: expected "
+                  << expected << ", got " << counts[0] << ", " << counts[1] << ", " << counts[2] << "\n";
+    }
+    return mismatches;
+}
+
+/* Differential test of the stencil kernels on "grids" random grids of
+ * random sizes, wide enough to span several 64-bit plane words. Small
+ * alphabets make the 5x5 stencils match often enough to matter.
+ * Returns the number of disagreements.
+ */
+size_t run_stencil_test(size_t grids, unsigned seed) {
+    static constexpr auto x_mas {make_x_stencil<3>("MAS")};
+    static constexpr auto x_5 {make_x_stencil<5>("MMASS")};
+    static constexpr auto corner_5 {make_stencil<5>("MAS.."
+                                                    "A...."
+                                                    "S..M."
+                                                    "...A."
+                                                    "..MAS")};
+    constexpr std::string_view alphabets[] {"MA", "MAS", "XMAS"};
+
+    std::mt19937 rng {seed};
+    std::uniform_int_distribution<int> rows {1, 40};
+    std::uniform_int_distribution<int> cols {1, 200};
+    std::uniform_int_distribution<size_t> pick {0, std::size(alphabets) - 1};
+
+    size_t mismatches {0};
+    std::string text;
+    for (size_t g = 0; g < grids; ++g) {
+        const auto alphabet {alphabets[pick(rng)]};
+        std::uniform_int_distribution<size_t> letter {0, alphabet.size() - 1};
+        const auto height {rows(rng)};
+        const auto width {cols(rng)};
+        text.clear();
+        for (int r = 0; r < height; ++r) {
+            for (int c = 0; c < width; ++c) {
+                text += alphabet[letter(rng)];
+            }
+            text += '\n';
+        }
+        Grid grid;
+        grid.load(text);
+        const auto report {mismatches < 10};
+        mismatches += check_stencil<x_mas>(grid, report) + check_stencil<x_5>(grid, report) +
+                      check_stencil<corner_5>(grid, report);
+    }
+    return mismatches;
+}
+
+// The result lines, shared by solve() and cli_main.
+std::string result_lines(int xmas_count, int x_shaped_mas_count) {
+    return "Result Part 1 (XMAS word count): " + std::to_string(xmas_count) + "\n" +
+           "Result Part 2 (MAS word count): " + std::to_string(x_shaped_mas_count) + "\n";
+}
+
+bool parse(std::string_view text, Input& input, std::string& error) {
+    input.grid.load(text);
+    if (input.grid.empty()) {
+        error = "Grid is empty.";
+        return false;
+    }
+    return true;
+}
+
+std::string solve(Input& input, unsigned threads, int band_rows) {
+    const auto& grid {input.grid};
+    constexpr std::string_view xmas_word {"XMAS"};
+    const LetterPlanes xmas_planes {grid, xmas_word, threads};
+    const auto xmas_count {count_in_bands(grid.rows(), band_rows, threads, [&](int r_begin, int r_end) {
+        return count_occurrences_bitplanes(xmas_planes, xmas_word, all_dirs, r_begin, r_end);
+    })};
+
+    constexpr std::string_view x_shaped_mas_word {"MAS"};
+    constexpr auto x_shaped_mas {make_x_stencil<3>(x_shaped_mas_word)};
+    const LetterPlanes mas_planes {grid, x_shaped_mas_word, threads};
+    const auto x_shaped_mas_count {count_in_bands(grid.rows(), band_rows, threads, [&](int r_begin, int r_end) {
+        return count_stencil_bitplanes<x_shaped_mas>(mas_planes, r_begin, r_end);
+    })};
+
+    return result_lines(xmas_count, x_shaped_mas_count);
+}
+
+int cli_main(int argc, char* argv[]) {
+    
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <input-file> [--engine=bitplane|scalar] [--threads N]"
+                     " [--band-rows N] [--words W1,W2,...] [--positions]"
+                     " [--cache DIR [--cache-size MiB]] [--stats[=json]] | --self-test [grids].\n";
+        return 1;
+    }
+
+    if (std::string_view{argv[1]} == "--self-test") {
+        size_t grids {2000};
+        if (argc > 2) {
+            const std::string_view value {argv[2]};
+            const auto [_, ec] = std::from_chars(value.data(), value.data() + value.size(), grids);
+            if (ec != std::errc()) {
+                std::cerr << "Invalid grid count '" << value << "'.\n";
+                return 1;
+            }
+        }
+        const auto mismatches {run_stencil_test(grids, 2024)};
+        std::cout << "Self-test: " << mismatches << " mismatches over " << grids << " grids.\n";
+        return mismatches == 0 ? 0 : 1;
+    }
+
+    // The cell-by-cell search is kept as the reference for the bit planes.
+    auto use_bitplanes {true};
+    aoc::ThreadOptions thread_options;
+    // Rows per band handed to a thread.
+    auto band_rows {64};
+    // Extra words counted in one pass, optionally with where they were found.
+    std::vector<std::string_view> words;
+    auto print_positions {false};
+    aoc::stats::Recorder stats;
+    aoc::CacheOptions cache;
+    for (int i = 2; i < argc; ++i) {
+        const std::string_view arg {argv[i]};
+        if (stats.parse_flag(arg) || thread_options.parse_flag(argc, argv, i) ||
+            cache.parse_flag(argc, argv, i)) {
+            continue;
+        } else if (arg == "--engine=bitplane") {
+            use_bitplanes = true;
+        } else if (arg == "--engine=scalar") {
+            use_bitplanes = false;
+        } else if (arg == "--words" && i + 1 < argc) {
+            for (const auto word : std::string_view {argv[++i]} | std::views::split(',')) {
+                words.emplace_back(word.begin(), word.end());
+            }
+        } else if (arg == "--positions") {
+            print_positions = true;
+        } else if (arg == "--band-rows" && i + 1 < argc) {
+            const std::string_view value {argv[++i]};
+            const auto [_, ec] = std::from_chars(value.data(), value.data() + value.size(), band_rows);
+            if (ec != std::errc() || band_rows <= 0) {
+                std::cerr << "Invalid value '" << value << "' for " << arg << ".\n";
+                return 1;
+            }
+        } else {
+            std::cerr << "Unknown option '" << arg << "'.\n";
+            return 1;
+        }
+    }
+    if (thread_options.invalid || cache.invalid) {
+        return 1;
+    }
+    const auto threads {thread_options.count};
+
+    if (cache.enabled()) {
+        // Cached results are the two-part lines of solve().
+        if (!words.empty()) {
+            std::cerr << "--cache can't be combined with --words.\n";
+            return 1;
+        }
+        return aoc::solve_cached<Input>(cache, solver_version, argv[1], parse,
+                                        [&](Input& input) { return solve(input, threads, band_rows); }, stats);
+    }
+
+    auto load_phase {stats.phase("load")};
+    const aoc::FileBuffer file {argv[1]};
+    if (!file.ok()) {
+        std::cerr << "Error: could not read or parse '" << argv[1] << "'.\n";
+        return 1;
+    }
+    Grid grid;
+    grid.load(file.view());
+
+    if (grid.empty()) {
+      std::cerr << "Grid is empty.\n";
+      return 1;  
+    }
+    load_phase.stop();
+
+    const auto& dirs {all_dirs};
+
+    // Part 1
+    constexpr std::string_view xmas_word {"XMAS"};
+    auto xmas_count {0};
+    if (use_bitplanes) {
+        auto planes_phase {stats.phase("planes")};
+        const LetterPlanes planes {grid, xmas_word, threads};
+        planes_phase.stop();
+        const auto part_phase {stats.phase("part1")};
+        xmas_count = count_in_bands(grid.rows(), band_rows, threads, [&](int r_begin, int r_end) {
+            return count_occurrences_bitplanes(planes, xmas_word, dirs, r_begin, r_end);
+        });
+    } else {
+        const auto part_phase {stats.phase("part1")};
+        xmas_count = count_in_bands(grid.rows(), band_rows, threads, [&](int r_begin, int r_end) {
+            return count_occurrences(grid, xmas_word, dirs, r_begin, r_end);
+        });
+    }
+
+    // Part 2
+    constexpr std::string_view x_shaped_mas_word {"MAS"};
+    constexpr auto x_shaped_mas {make_x_stencil<3>(x_shaped_mas_word)};
+    auto x_shaped_mas_count {0};
+    if (use_bitplanes) {
+        auto planes_phase {stats.phase("planes")};
+        const LetterPlanes planes {grid, x_shaped_mas_word, threads};
+        planes_phase.stop();
+        const auto part_phase {stats.phase("part2")};
+        x_shaped_mas_count = count_in_bands(grid.rows(), band_rows, threads, [&](int r_begin, int r_end) {
+            return count_stencil_bitplanes<x_shaped_mas>(planes, r_begin, r_end);
+        });
+    } else {
+        const auto part_phase {stats.phase("part2")};
+        x_shaped_mas_count = count_in_bands(grid.rows(), band_rows, threads, [&](int r_begin, int r_end) {
+            return count_stencil<x_shaped_mas>(grid, r_begin, r_end);
+        });
+    }
+
+    auto output_phase {stats.phase("output")};
+    std::cout << result_lines(xmas_count, x_shaped_mas_count);
+    output_phase.stop();
+
+    if (!words.empty()) {
+        // One result per band, gathered in row order.
+        const auto words_phase {stats.phase("words")};
+        const WordSearch search {words, dirs};
+        const auto bands {(grid.rows() + band_rows - 1) / band_rows};
+        std::vector<std::vector<int>> band_counts(bands);
+        std::vector<std::vector<WordMatch>> band_matches(bands);
+        for_each_band(grid.rows(), band_rows, threads, [&](int r_begin, int r_end) {
+            const auto band {r_begin / band_rows};
+            band_counts[band] = search.count(grid, r_begin, r_end, print_positions ? &band_matches[band] : nullptr);
+        });
+
+        for (size_t w = 0; w < words.size(); ++w) {
+            auto count {0};
+            for (const auto& counts : band_counts) {
+                count += counts[w];
+            }
+            std::cout << "Word '" << words[w] << "': " << count << "\n";
+        }
+        for (const auto& matches : band_matches) {
+            for (const auto& match : matches) {
+                std::cout << words[match.word] << " at (" << match.row << ", " << match.col
+                          << ") dir (" << match.r_dir << ", " << match.c_dir << ")\n";
+            }
+        }
+    }
+
+    stats.report();
+    return 0;
+}
+
+}  // namespace day4
@@ -0,0 +1,30 @@
+/*
+ * Day 4: Ceres Search, the solver's interface (implemented in day4.cpp).
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "grid.h"
+
+namespace day4 {
+
+inline constexpr std::string_view solver_version {"day4-v1"};
+
+// The grid may point into the input text, which must outlive it.
+struct Input {
+    Grid grid;
+};
+
+// Loads the grid of "text", which must not be empty.
+bool parse(std::string_view text, Input& input, std::string& error);
+
+// Counts both parts with the bit planes, in bands of "band_rows" rows
+// spread over "threads" workers, and returns the result lines.
+std::string solve(Input& input, unsigned threads = 1, int band_rows = 64);
+
+int cli_main(int argc, char* argv[]);
+
+}  // namespace day4
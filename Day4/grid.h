@@ -0,0 +1,125 @@
+/*
+ * The Day4 letter grid, shared by the solver (day4.cpp) and its Input.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+namespace day4 {
+
+/*
+ * Row-major letter grid in a single block of memory. Rows are "stride" bytes
+ * apart, so a text of equal-length lines is used as-is, in place, with its
+ * line endings between the rows. Other texts are normalized into an owned
+ * copy. Only cells inside the grid may be read: the searches bound their
+ * walks by rows() and cols().
+ */
+class Grid {
+public:
+    Grid() = default;
+
+    Grid(const Grid&) = delete;
+    Grid& operator=(const Grid&) = delete;
+
+    /*
+     * Loads the non-empty lines of "text", which must outlive the grid when
+     * it is used in place. Rows shorter than the first one are padded with
+     * '\0' cells, which match no letter, and longer ones are cut.
+     */
+    void load(std::string_view text) {
+        owned_.clear();
+        if (!measure(text, rows_, cols_, stride_)) {
+            copy(text);
+            return;
+        }
+        cells_ = text.data();
+    }
+
+    int rows() const { return rows_; }
+    int cols() const { return cols_; }
+    bool empty() const { return rows_ == 0 || cols_ == 0; }
+    // Distance in bytes between vertically adjacent cells.
+    std::ptrdiff_t stride() const { return stride_; }
+
+    // Cell (r, c) of the grid.
+    char operator()(int r, int c) const { return cells_[r * stride_ + c]; }
+    const char* row(int r) const { return cells_ + r * stride_; }
+
+private:
+    /*
+     * Recognizes the layout used in place: a block of equal-length lines
+     * ("\n" or "\r\n" endings, last one optional, nothing after it).
+     */
+    static bool measure(std::string_view text, int& rows, int& cols, std::ptrdiff_t& stride) {
+        const auto first_newline {text.find('\n')};
+        if (first_newline == 0 || first_newline == std::string_view::npos) {
+            return false;
+        }
+        const auto crlf {text[first_newline - 1] == '\r'};
+        const auto width {first_newline - (crlf ? 1 : 0)};
+        const auto line {first_newline + 1};
+        const auto full_lines {text.size() / line};
+        const auto rest {text.size() % line};
+        // An unterminated last row is fine, anything else isn't.
+        if (rest != 0 && rest != width) {
+            return false;
+        }
+        for (size_t r = 0; r < full_lines + (rest != 0); ++r) {
+            const auto row {text.substr(r * line, width)};
+            if (row.find_first_of("\r\n") != std::string_view::npos) {
+                return false;
+            }
+            if (r < full_lines && (text[r * line + line - 1] != '\n' || (crlf && text[r * line + width] != '\r'))) {
+                return false;
+            }
+        }
+        rows = static_cast<int>(full_lines + (rest != 0));
+        cols = static_cast<int>(width);
+        stride = static_cast<std::ptrdiff_t>(line);
+        return true;
+    }
+
+    // Fallback: lays the lines out back to back.
+    void copy(std::string_view text) {
+        std::vector<std::string_view> lines;
+        size_t start {0};
+        while (start < text.size()) {
+            auto end {text.find('\n', start)};
+            if (end == std::string_view::npos) {
+                end = text.size();
+            }
+            auto line {text.substr(start, end - start)};
+            if (!line.empty() && line.back() == '\r') {
+                line.remove_suffix(1);
+            }
+            if (!line.empty()) {
+                lines.push_back(line);
+            }
+            start = end + 1;
+        }
+
+        rows_ = static_cast<int>(lines.size());
+        cols_ = lines.empty() ? 0 : static_cast<int>(lines[0].size());
+        stride_ = cols_;
+        owned_.assign(static_cast<size_t>(rows_) * static_cast<size_t>(stride_), '\0');
+        cells_ = owned_.data();
+        for (int r = 0; r < rows_; ++r) {
+            const auto width {std::min<size_t>(lines[r].size(), static_cast<size_t>(cols_))};
+            std::memcpy(owned_.data() + r * stride_, lines[r].data(), width);
+        }
+    }
+
+    const char* cells_ {nullptr};
+    int rows_ {0};
+    int cols_ {0};
+    std::ptrdiff_t stride_ {0};
+    // Backing storage of a normalized copy; empty when used in place.
+    std::vector<char> owned_;
+};
+
+}  // namespace day4
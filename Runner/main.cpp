@@ -0,0 +1,299 @@
+/*
+ * aoc: runs any number of Day1 to Day4 inputs in one process.
+ *
+ * Each input is a job with a parse stage and a compute stage, run as tasks
+ * on one shared work-stealing pool: a parse task submits its compute task
+ * when it is done. Parse tasks are submitted in job order, a window at a
+ * time, and a background thread reads that window into the page cache ahead
+ * of the workers, so parse stages find their inputs warm. Results are printed
+ * in the order the jobs were given, whatever order they finish in.
+ *
+ *   aoc [--threads N] [--cache DIR [--cache-size MiB]] [--list FILE] [DAY:PATH ...]
+ *
+ * FILE holds one "DAY PATH" pair per line, for batches too long for the
+ * command line. With --cache, a job whose input was solved before skips
+ * both stages.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../Common/file_buffer.h"
+#include "../Common/result_cache.h"
+#include "../Common/thread_pool.h"
+#include "../Day1/day1.h"
+#include "../Day2/day2.h"
+#include "../Day3/day3.h"
+#include "../Day4/day4.h"
+
+struct Job {
+    int day {0};
+    std::string path;
+    // The result lines, or the error.
+    std::string output;
+    bool ok {false};
+};
+
+/*
+ * Pulls the job inputs into the page cache on a background thread, in job
+ * order, staying at most "window" jobs ahead of the parse stages so a long
+ * batch doesn't evict inputs before they are read. The parse tasks are
+ * submitted in the same order and window, so it warms the jobs that run
+ * next.
+ */
+class Prefetcher {
+public:
+    Prefetcher(const std::vector<Job>& jobs, size_t window)
+        : jobs_ {jobs}, window_ {window}, thread_ {[this] { run(); }} {}
+
+    ~Prefetcher() {
+        {
+            std::lock_guard lock {mutex_};
+            stopping_ = true;
+        }
+        advanced_.notify_all();
+        thread_.join();
+    }
+
+    Prefetcher(const Prefetcher&) = delete;
+    Prefetcher& operator=(const Prefetcher&) = delete;
+
+    // Called as each parse stage starts.
+    void started() {
+        {
+            std::lock_guard lock {mutex_};
+            ++started_;
+        }
+        advanced_.notify_one();
+    }
+
+private:
+    void run() {
+        for (size_t j = 0; j < jobs_.size(); ++j) {
+            {
+                std::unique_lock lock {mutex_};
+                advanced_.wait(lock, [&] { return stopping_ || j < started_ + window_; });
+                if (stopping_) {
+                    return;
+                }
+            }
+            prefetch(jobs_[j].path);
+        }
+    }
+
+    static void prefetch(const std::string& path) {
+        // Only regular files: opening a FIFO here would block, or take its
+        // data away from the parse stage.
+        struct stat st {};
+        if (::stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+            return;
+        }
+        const auto fd {::open(path.c_str(), O_RDONLY)};
+        if (fd < 0) {
+            return;
+        }
+#if defined(__linux__)
+        // Blocks until the file is read in, which is the point here.
+        ::readahead(fd, 0, static_cast<size_t>(st.st_size));
+#else
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+#endif
+        ::close(fd);
+    }
+
+    const std::vector<Job>& jobs_;
+    const size_t window_;
+    std::mutex mutex_;
+    std::condition_variable advanced_;
+    size_t started_ {0};
+    bool stopping_ {false};
+    std::thread thread_;
+};
+
+/*
+ * Queues the parse stage of "job"; on success it queues the compute stage.
+ * As it starts, the parse task calls submit_next() to queue the next job.
+ * The parse task reads the input once and both stages share it, with the
+ * day's Input. With a cache, the parse task first looks the input bytes up
+ * under the day's "solver" tag, and the compute task stores what it computed.
+ */
+template <typename Input>
+void schedule(aoc::WorkStealingPool& pool, Prefetcher& prefetcher, aoc::ResultCache* cache, Job& job,
+              const std::function<void()>& submit_next, std::string_view solver,
+              bool (*parse)(std::string_view, Input&, std::string&), std::string (*solve)(Input&)) {
+    pool.submit([&pool, &prefetcher, cache, &job, solver, parse, solve, &submit_next] {
+        prefetcher.started();
+        submit_next();
+        auto file {std::make_shared<const aoc::FileBuffer>(job.path)};
+        if (!file->ok()) {
+            job.output = "Error: could not read or parse '" + job.path + "'.";
+            return;
+        }
+        std::string key;
+        if (cache) {
+            key = aoc::ResultCache::key(solver, file->view());
+            if (cache->lookup(key, job.output)) {
+                job.ok = true;
+                return;
+            }
+        }
+        auto input {std::make_shared<Input>()};
+        if (!parse(file->view(), *input, job.output)) {
+            return;
+        }
+        pool.submit([cache, &job, key {std::move(key)}, file, input, solve] {
+            job.output = solve(*input);
+            job.ok = true;
+            if (!key.empty()) {
+                cache->store(key, job.output);
+            }
+        });
+    });
+}
+
+/*
+ * Parses "DAY:PATH" (or "DAY" and "PATH" from a list file) into "job".
+ * Returns false if the day isn't 1 to 4 or the path is missing.
+ */
+bool make_job(std::string_view day, std::string_view path, Job& job) {
+    if (day.size() != 1 || day[0] < '1' || day[0] > '4' || path.empty()) {
+        return false;
+    }
+    job.day = day[0] - '0';
+    job.path = path;
+    return true;
+}
+
+bool read_list(const std::string& filename, std::vector<Job>& jobs) {
+    std::ifstream list {filename};
+    if (!list) {
+        return false;
+    }
+    std::string day, path;
+    while (list >> day >> path) {
+        Job job;
+        if (!make_job(day, path, job)) {
+            std::cerr << "Invalid entry '" << day << " " << path << "' in '" << filename << "'.\n";
+            return false;
+        }
+        jobs.push_back(std::move(job));
+    }
+    return !list.bad();
+}
+
+int main(int argc, char* argv[]) {
+
+    aoc::ThreadOptions thread_options;
+    aoc::CacheOptions cache_options;
+    std::vector<Job> jobs;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg {argv[i]};
+        if (thread_options.parse_flag(argc, argv, i) || cache_options.parse_flag(argc, argv, i)) {
+            if (thread_options.invalid || cache_options.invalid) {
+                return 1;
+            }
+        } else if (arg == "--list" && i + 1 < argc) {
+            if (!read_list(argv[++i], jobs)) {
+                std::cerr << "Error: could not read the job list '" << argv[i] << "'.\n";
+                return 1;
+            }
+        } else {
+            const auto colon {arg.find(':')};
+            Job job;
+            if (colon == std::string_view::npos || !make_job(arg.substr(0, colon), arg.substr(colon + 1), job)) {
+                std::cerr << "Usage: " << argv[0] << " [--threads N] [--cache DIR [--cache-size MiB]]"
+                             " [--list FILE] [DAY:PATH ...]\n"
+                          << "FILE holds one \"DAY PATH\" pair per line; DAY is 1 to 4.\n";
+                return 1;
+            }
+            jobs.push_back(std::move(job));
+        }
+    }
+
+    std::optional<aoc::ResultCache> cache;
+    if (cache_options.enabled()) {
+        cache.emplace(cache_options);
+        if (!cache->ok()) {
+            std::cerr << "Error: could not use the cache directory '" << cache_options.dir << "'.\n";
+            return 1;
+        }
+    }
+
+    {
+        // The prefetcher outlives the pool, whose tasks report to it.
+        const auto window {size_t{thread_options.count} * 4};
+        Prefetcher prefetcher {jobs, window};
+        aoc::WorkStealingPool pool {thread_options.count};
+        auto* const shared_cache {cache ? &*cache : nullptr};
+        // Each job solves on its own worker; the pool runs the jobs in parallel.
+        // Only the prefetch window is queued up front: the pool pops its own
+        // queue last in, first out, so queuing every job at once would run
+        // them far from job order.
+        std::atomic<size_t> next_job {0};
+        std::function<void()> submit_next;
+        submit_next = [&] {
+            const auto j {next_job++};
+            if (j >= jobs.size()) {
+                return;
+            }
+            auto& job {jobs[j]};
+            switch (job.day) {
+                case 1:
+                    schedule<day1::Input>(pool, prefetcher, shared_cache, job, submit_next,
+                                          day1::solver_version, day1::parse,
+                                          [](day1::Input& input) { return day1::solve(input); });
+                    break;
+                case 2:
+                    schedule<day2::Input>(pool, prefetcher, shared_cache, job, submit_next,
+                                          day2::solver_version, day2::parse,
+                                          [](day2::Input& input) { return day2::solve(input); });
+                    break;
+                case 3:
+                    schedule<day3::Input>(pool, prefetcher, shared_cache, job, submit_next,
+                                          day3::solver_version, day3::parse,
+                                          [](day3::Input& input) { return day3::solve(input); });
+                    break;
+                case 4:
+                    schedule<day4::Input>(pool, prefetcher, shared_cache, job, submit_next,
+                                          day4::solver_version, day4::parse,
+                                          [](day4::Input& input) { return day4::solve(input); });
+                    break;
+            }
+        };
+        for (size_t j = 0; j < window && j < jobs.size(); ++j) {
+            submit_next();
+        }
+        pool.wait();
+    }
+
+    auto failed {0};
+    for (const auto& job : jobs) {
+        std::cout << "== Day " << job.day << ": " << job.path << "\n";
+        if (job.ok) {
+            std::cout << job.output;
+        } else {
+            std::cout << job.output << "\n";
+            ++failed;
+        }
+    }
+    if (cache) {
+        std::cerr << "Cache: " << cache->hits() << " hits, " << cache->misses() << " misses.\n";
+    }
+
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,19 @@
+# Output check, run by ctest with cmake -P.
+#
+# Runs PROGRAM on INPUT, followed by the space-separated options in ARGS if
+# given, and fails unless it exits with 0 and its stdout equals the file
+# EXPECTED.
+
+separate_arguments(args UNIX_COMMAND "${ARGS}")
+execute_process(
+    COMMAND ${PROGRAM} ${INPUT} ${args}
+    OUTPUT_VARIABLE output
+    RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "${PROGRAM} ${INPUT} ${ARGS} exited with ${result}")
+endif()
+
+file(READ ${EXPECTED} expected)
+if(NOT output STREQUAL expected)
+    message(FATAL_ERROR "${PROGRAM} ${INPUT} ${ARGS} printed:\n${output}\nexpected (${EXPECTED}):\n${expected}")
+endif()
@@ -0,0 +1,54 @@
+# Two-stage profile-guided build, run by the "pgo" target with cmake -P.
+#
+# Expects SOURCE_DIR, BINARY_DIR, GENERATOR, CXX_COMPILER, COMPILER_ID,
+# AOC_NATIVE, AOC_LTO, BENCH and TRAINING_SIZE to be defined.
+
+set(profiles ${BINARY_DIR}/profiles)
+set(days day1 day2 day3 day4)
+
+function(configure_stage stage)
+    execute_process(
+        COMMAND ${CMAKE_COMMAND} -S ${SOURCE_DIR} -B ${BINARY_DIR} -G ${GENERATOR}
+            -DCMAKE_BUILD_TYPE=Release
+            -DCMAKE_CXX_COMPILER=${CXX_COMPILER}
+            -DAOC_NATIVE=${AOC_NATIVE}
+            -DAOC_LTO=${AOC_LTO}
+            -DAOC_PGO=${stage}
+            -DAOC_PGO_DIR=${profiles}
+        COMMAND_ERROR_IS_FATAL ANY)
+    execute_process(
+        COMMAND ${CMAKE_COMMAND} --build ${BINARY_DIR} --target ${days}
+        COMMAND_ERROR_IS_FATAL ANY)
+endfunction()
+
+# Stage 1: instrumented executables, trained on every day's generated input.
+file(REMOVE_RECURSE ${profiles})
+configure_stage(generate)
+message(STATUS "PGO: training on ${TRAINING_SIZE} inputs")
+execute_process(
+    COMMAND ${BENCH} --size ${TRAINING_SIZE} --runs 1
+        --bin-dir ${BINARY_DIR} --work-dir ${BINARY_DIR}
+    OUTPUT_QUIET
+    COMMAND_ERROR_IS_FATAL ANY)
+# Day1 lists take the 16-bit radix sort only past 2^20 values, so its widest
+# IDs also train on inputs twice as large.
+string(REGEX MATCH "^([0-9]+)(.*)$" _ ${TRAINING_SIZE})
+math(EXPR day1_size "${CMAKE_MATCH_1} * 2")
+execute_process(
+    COMMAND ${BENCH} --day 1 --digits 9 --size ${day1_size}${CMAKE_MATCH_2} --runs 1
+        --bin-dir ${BINARY_DIR} --work-dir ${BINARY_DIR}
+    OUTPUT_QUIET
+    COMMAND_ERROR_IS_FATAL ANY)
+
+# Clang writes raw profiles that must be merged first.
+if(COMPILER_ID MATCHES "Clang")
+    find_program(LLVM_PROFDATA NAMES llvm-profdata REQUIRED)
+    file(GLOB raw_profiles ${profiles}/*.profraw)
+    execute_process(
+        COMMAND ${LLVM_PROFDATA} merge -output=${profiles}/default.profdata ${raw_profiles}
+        COMMAND_ERROR_IS_FATAL ANY)
+endif()
+
+# Stage 2: the same build directory, rebuilt with the profiles.
+configure_stage(use)
+message(STATUS "PGO: optimized executables are in ${BINARY_DIR}")